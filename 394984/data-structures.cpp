@@ -3,14 +3,51 @@
 #include <iostream>
 #include <cstring>
 
-Transaction::Transaction(version gvc, bool is_ro_): rv{gvc}, is_ro{is_ro_} {}
+Transaction::Transaction(version gvc, bool is_ro_, bool is_elastic_, WordPool* pool_): rv{gvc}, is_ro{is_ro_}, is_elastic{is_elastic_}, window_size{0}, has_read{false}, pool{pool_} {}
 
 Transaction::~Transaction() {
+    clear();
+}
+
+void Transaction::clear() {
     // Free all of the segments so that they don't appear to the other transactions
     for (auto& seg : seg_list) {
         free(seg);
     }
     seg_list.clear();
+    // The containers keep their memory, which is the point of reusing a descriptor
+    read_set.clear();
+    write_set.clear();
+    scans.clear();
+    window_size = 0;
+    has_read = false;
+}
+
+void Transaction::reset(version gvc, bool is_ro_, bool is_elastic_) {
+    clear();
+    rv = gvc;
+    is_ro = is_ro_;
+    is_elastic = is_elastic_;
+}
+
+void Transaction::pushElasticRead(char* addr, word version) {
+    // Shift out the oldest read, the window is tiny so this is cheaper than a ring buffer
+    if (window_size == ELASTIC_WINDOW) {
+        for (size_t i = 1; i < ELASTIC_WINDOW; i++) {
+            window[i - 1] = window[i];
+        }
+        window_size--;
+    }
+    window[window_size++] = ElasticRead{addr, version};
+}
+
+void Transaction::hardenElastic() {
+    // The first write ends the elastic phase, from now on the last reads must hold until commit
+    for (size_t i = 0; i < window_size; i++) {
+        read_set.insert(window[i].addr);
+    }
+    window_size = 0;
+    is_elastic = false;
 }
 
 MemoryRegion::MemoryRegion(size_t size_, size_t align_): size{size_}, align{align_}, locks{nullptr}, start{nullptr} {}
@@ -28,16 +65,94 @@ MemoryRegion::~MemoryRegion() {
     free(start);
 }
 
-WriteOperation::WriteOperation(char* data, size_t word_size): val{aligned_alloc(word_size, word_size)} {
-    // val holds the data we want to write
+WordPool::WordPool(): word_size{0} {}
+
+WordPool::~WordPool() {
+    for (auto buffer : spare) {
+        free(buffer);
+    }
+}
+
+void* WordPool::get(size_t word_size_) {
+    // A thread may move on to a region with another alignment, in which case the cached buffers are useless
+    if (unlikely(word_size_ != word_size)) {
+        for (auto buffer : spare) {
+            free(buffer);
+        }
+        spare.clear();
+        word_size = word_size_;
+    }
+    if (spare.empty()) return aligned_alloc(word_size, word_size);
+    void* buffer = spare.back();
+    spare.pop_back();
+    return buffer;
+}
+
+void WordPool::put(void* buffer) {
+    spare.push_back(buffer);
+}
+
+WriteOperation::WriteOperation(char* data, size_t word_size, bool is_delta_, WordPool* pool_): val{pool_ ? pool_->get(word_size) : aligned_alloc(word_size, word_size)}, is_delta{is_delta_}, pool{pool_} {
+    // val holds the data we want to write (or the increment if is_delta)
     memcpy(val, data, word_size);
 }
 
+// Add two words of the given width as integers, dst += src
+template<class Int> static void addWord(void* dst, void const* src) {
+    Int a, b;
+    memcpy(&a, dst, sizeof(Int));
+    memcpy(&b, src, sizeof(Int));
+    a += b;
+    memcpy(dst, &a, sizeof(Int));
+}
+
+static void addWord(void* dst, void const* src, size_t word_size) {
+    switch (word_size) {
+    case 1: addWord<uint8_t>(dst, src); break;
+    case 2: addWord<uint16_t>(dst, src); break;
+    case 4: addWord<uint32_t>(dst, src); break;
+    case 8: addWord<uint64_t>(dst, src); break;
+    }
+}
+
+bool isIntegerWord(size_t word_size) {
+    return word_size == 1 || word_size == 2 || word_size == 4 || word_size == 8;
+}
+
+void WriteOperation::accumulate(intptr_t delta, size_t word_size) {
+    // Truncate the delta to the width of a word, unsigned wrap-around takes care of the sign
+    uint64_t wide = static_cast<uint64_t>(delta);
+    uint8_t u8 = static_cast<uint8_t>(wide);
+    uint16_t u16 = static_cast<uint16_t>(wide);
+    uint32_t u32 = static_cast<uint32_t>(wide);
+    void const* src = word_size == 1 ? (void const*)&u8 : word_size == 2 ? (void const*)&u16 : word_size == 4 ? (void const*)&u32 : (void const*)&wide;
+    // Works the same whether val is an absolute value or a pending increment
+    addWord(val, src, word_size);
+}
+
+void WriteOperation::applyTo(void* target, size_t word_size) {
+    if (is_delta) {
+        // The lock is held, so the committed value cannot change under us
+        addWord(target, val, word_size);
+    } else {
+        memcpy(target, val, word_size);
+    }
+}
+
 WriteOperation::~WriteOperation() {
-    free(val);
+    if (pool) pool->put(val);
+    else free(val);
 }
 
+ThreadSlot::ThreadSlot(): taken{false}, commits{0}, aborts{0}, false_conflicts{0} {}
+
+ThreadContext::ThreadContext(ThreadSlot* slot_): pool{}, txn{0, false, false, &pool}, txn_busy{false}, slot{slot_} {}
+
+#ifdef TM_COUNT_FALSE_CONFLICTS
+VersionedWriteLock::VersionedWriteLock(): version_and_lock{0}, last_addr{0} {};
+#else
 VersionedWriteLock::VersionedWriteLock(): version_and_lock{0} {};
+#endif
 
 bool VersionedWriteLock::lock() {
     // A possible optimization is to spin while continually checking the lock. I found that in our case it is better to just restart the transaction.
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <map>
 #include <list>
+#include <vector>
 #include <atomic>
 #include <mutex>
 #include <memory>
@@ -21,9 +22,31 @@ using version = uint64_t;
 
 constexpr size_t NUM_LOCKS = 10000;
 
+// Size of a cache line, used to prefetch data ahead of vectored reads
+constexpr size_t CACHE_LINE = 64;
+
+// Number of times a commit yields waiting for a busy lock it only needs for increments, before giving up
+constexpr size_t DELTA_LOCK_YIELDS = 256;
+
+// Number of slots in the thread table, threads past that share one slot
+constexpr size_t MAX_THREADS = 512;
+
+// Number of bytes a scan copies at once, between sampling and re-checking the stripes that cover them
+constexpr size_t SCAN_CHUNK = 4096;
+
+// Number of times a scan retries one chunk before aborting the transaction
+constexpr size_t SCAN_RETRIES = 8;
+
+// Number of most recent reads an elastic transaction keeps track of before its first write
+constexpr size_t ELASTIC_WINDOW = 2;
+
 //Our special spinlock which holds a version in addition to the lock bit
 struct VersionedWriteLock {
     atomic<word> version_and_lock;
+#ifdef TM_COUNT_FALSE_CONFLICTS
+    // Address the last committer locked this stripe for, to tell false conflicts (same stripe, other address) apart
+    atomic<word> last_addr;
+#endif
     VersionedWriteLock();
     bool lock();
     void unlock();
@@ -44,10 +67,40 @@ struct MemoryRegion {
     ~MemoryRegion();
 };
 
+// Per-thread allocation cache for the value buffers of write operations, which all have the size of a word
+struct WordPool {
+    vector<void*> spare;
+    size_t word_size;
+    WordPool();
+    ~WordPool();
+    void* get(size_t word_size_);
+    void put(void* buffer);
+};
+
 struct WriteOperation {
     void* val;
-    WriteOperation(char* data, size_t word_size);
+    // When set, val holds an increment to apply on the committed value instead of the value itself
+    bool is_delta;
+    // Where val comes from and goes back to, nullptr for plain aligned_alloc/free
+    WordPool* pool;
+    WriteOperation(char* data, size_t word_size, bool is_delta_ = false, WordPool* pool_ = nullptr);
     ~WriteOperation();
+    void accumulate(intptr_t delta, size_t word_size);
+    void applyTo(void* target, size_t word_size);
+};
+
+bool isIntegerWord(size_t word_size);
+
+// A read that an elastic transaction has not committed to its read-set (yet)
+struct ElasticRead {
+    char* addr;
+    word version;
+};
+
+// A range copied by a scan, validated as a whole at commit instead of word by word through the read-set
+struct ScanRange {
+    char* start;
+    size_t size;
 };
 
 struct Transaction {
@@ -56,8 +109,45 @@ struct Transaction {
     unordered_map<char*, unique_ptr<WriteOperation>> write_set;
     list<void*> seg_list;
     bool is_ro;
-    Transaction(version gvc, bool is_ro_);
+    // While elastic, reads only go in the window and only need to be consistent with each other
+    bool is_elastic;
+    ElasticRead window[ELASTIC_WINDOW];
+    size_t window_size;
+    // Scratch space for the versions sampled by a vectored read
+    vector<word> versions;
+    // Ranges scanned by a write transaction
+    vector<ScanRange> scans;
+    // Whether a read-only transaction read anything outside of a scan, which it cannot revalidate to move its snapshot forward
+    bool has_read;
+    // Buffer cache of the thread running the transaction, if any
+    WordPool* pool;
+    Transaction(version gvc, bool is_ro_, bool is_elastic_ = false, WordPool* pool_ = nullptr);
     ~Transaction();
+    void reset(version gvc, bool is_ro_, bool is_elastic_);
+    void clear();
+    void pushElasticRead(char* addr, word version);
+    void hardenElastic();
+};
+
+// One entry of the thread table, on its own cache line since it is written by its owner on every transaction
+struct alignas(CACHE_LINE) ThreadSlot {
+    atomic<bool> taken;
+    // Stats block of the owner
+    atomic<uint64_t> commits;
+    atomic<uint64_t> aborts;
+    atomic<uint64_t> false_conflicts;
+    ThreadSlot();
+};
+
+// Everything a thread keeps around from one transaction to the next
+struct ThreadContext {
+    // Declared first so that it outlives the write operations of txn
+    WordPool pool;
+    // Handed out by tm_begin whenever the thread is not already running a transaction
+    Transaction txn;
+    bool txn_busy;
+    ThreadSlot* slot;
+    ThreadContext(ThreadSlot* slot_);
 };
 
 
@@ -24,6 +24,18 @@
         (prop)
 #endif
 
+/** Hint the processor to bring a cache line in before it is needed.
+ * @param addr Address in the cache line
+**/
+#undef prefetch
+#ifdef __GNUC__
+    #define prefetch(addr) \
+        __builtin_prefetch((addr))
+#else
+    #define prefetch(addr) \
+        ((void) (addr))
+#endif
+
 /** Define a variable as unused.
 **/
 #undef unused
@@ -32,6 +32,7 @@
 
 // Internal headers
 #include <tm.hpp>
+#include <tm-ext.hpp>
 #include "data-structures.hpp"
 #include "macros.hpp"
 
@@ -39,7 +40,149 @@
 // This is our global version clock.
 atomic<version> gvc{0};
 
+// The thread table, with one slot per registered thread
+ThreadSlot thread_slots[MAX_THREADS];
+// Shared by the threads that did not get a slot of their own
+ThreadSlot overflow_slot;
+// Stats of the threads that already left
+atomic<uint64_t> retired_commits{0};
+atomic<uint64_t> retired_aborts{0};
+atomic<uint64_t> retired_false_conflicts{0};
+
 using namespace std;
+
+// Context of the calling thread, nullptr until the thread registers (explicitly or not)
+static thread_local ThreadContext* context = nullptr;
+
+// Gives the slot of implicitly registered threads back when they terminate
+struct ContextGuard {
+    ~ContextGuard() {
+        tm_thread_exit();
+    }
+};
+static thread_local ContextGuard context_guard;
+
+// Get the context of the calling thread, registering it if it did not do it itself
+static inline ThreadContext* threadContext() {
+    if (unlikely(!context)) {
+        if (!tm_thread_enter()) return nullptr;
+        // Touching the guard makes sure its destructor runs when the thread exits
+        (void)&context_guard;
+    }
+    return context;
+}
+
+// Hand out a descriptor for a new transaction, the one of the thread context if it is free
+static inline Transaction* startTransaction(bool is_ro, bool is_elastic) {
+    ThreadContext* ctx = threadContext();
+    if (likely(ctx && !ctx->txn_busy)) {
+        Transaction* txn = &ctx->txn;
+        txn->reset(gvc.load(), is_ro, is_elastic);
+        ctx->txn_busy = true;
+        return txn;
+    }
+    // The thread runs more than one transaction at a time, the extra ones are allocated
+    return new(nothrow) Transaction(gvc.load(), is_ro, is_elastic);
+}
+
+// Account for a transaction that committed or aborted, and recycle or free its descriptor
+static inline void finishTransaction(Transaction* txn, bool committed) {
+    ThreadContext* ctx = context;
+    if (likely(ctx)) {
+        if (committed) ctx->slot->commits.fetch_add(1, memory_order_relaxed);
+        else ctx->slot->aborts.fetch_add(1, memory_order_relaxed);
+        if (likely(txn == &ctx->txn)) {
+            txn->clear();
+            ctx->txn_busy = false;
+            return;
+        }
+    }
+    delete txn;
+}
+
+// Abort on a conflict over the given lock, counting it as a false conflict if the lock was last taken for another address than ours.
+// The address is stored after the lock is taken, so we may see the previous holder's: the count is only an estimate.
+static inline bool conflictAbort(Transaction* txn, VersionedWriteLock* unused(lock), char* unused(addr)) {
+#ifdef TM_COUNT_FALSE_CONFLICTS
+    ThreadContext* ctx = context;
+    if (likely(ctx) && lock->last_addr.load(memory_order_relaxed) != (word)addr) ctx->slot->false_conflicts.fetch_add(1, memory_order_relaxed);
+#endif
+    finishTransaction(txn,false);
+    return false;
+}
+
+// Remember which address a committer took a stripe for, readers use it to count false conflicts
+static inline void markLock(VersionedWriteLock* unused(lock), void* unused(addr)) {
+#ifdef TM_COUNT_FALSE_CONFLICTS
+    lock->last_addr.store((word)addr,memory_order_relaxed);
+#endif
+}
+
+/** [thread-safe] Register the calling thread, setting up its context (reusable descriptor and buffers, stats slot).
+ * Threads that do not call it are registered on their first transaction.
+ * @return Whether the thread is registered
+**/
+bool tm_thread_enter() noexcept {
+    if (context) return true;
+
+    // Look for a free slot, falling back to the shared one if there is none left
+    ThreadSlot* slot = &overflow_slot;
+    for (size_t i = 0; i < MAX_THREADS; i++) {
+        bool expected = false;
+        if (!thread_slots[i].taken.load(memory_order_relaxed) && thread_slots[i].taken.compare_exchange_strong(expected, true)) {
+            slot = &thread_slots[i];
+            break;
+        }
+    }
+
+    context = new(nothrow) ThreadContext(slot);
+    if (unlikely(!context)) {
+        if (slot != &overflow_slot) slot->taken.store(false);
+        return false;
+    }
+    return true;
+}
+
+/** [thread-safe] Unregister the calling thread, freeing its context. The thread must not be running a transaction.
+**/
+void tm_thread_exit() noexcept {
+    ThreadContext* ctx = context;
+    if (!ctx) return;
+    context = nullptr;
+
+    ThreadSlot* slot = ctx->slot;
+    if (slot != &overflow_slot) {
+        // Move the stats out of the slot before someone else takes it
+        retired_commits.fetch_add(slot->commits.exchange(0));
+        retired_aborts.fetch_add(slot->aborts.exchange(0));
+        retired_false_conflicts.fetch_add(slot->false_conflicts.exchange(0));
+        slot->taken.store(false);
+    }
+    delete ctx;
+}
+
+/** [thread-safe] Get the number of transactions that committed and aborted so far, over all threads.
+ * @param counters Counters to fill
+**/
+void tm_stats(tm_counters* counters) noexcept {
+    uint64_t commits = retired_commits.load() + overflow_slot.commits.load(memory_order_relaxed);
+    uint64_t aborts = retired_aborts.load() + overflow_slot.aborts.load(memory_order_relaxed);
+    uint64_t false_conflicts = retired_false_conflicts.load() + overflow_slot.false_conflicts.load(memory_order_relaxed);
+    for (size_t i = 0; i < MAX_THREADS; i++) {
+        commits += thread_slots[i].commits.load(memory_order_relaxed);
+        aborts += thread_slots[i].aborts.load(memory_order_relaxed);
+        false_conflicts += thread_slots[i].false_conflicts.load(memory_order_relaxed);
+    }
+    counters->commits = commits;
+    counters->aborts = aborts;
+#ifdef TM_COUNT_FALSE_CONFLICTS
+    counters->false_conflicts = false_conflicts;
+#else
+    (void)false_conflicts;
+    counters->false_conflicts = tm_uncounted;
+#endif
+}
+
 /** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
  * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
  * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
@@ -113,7 +256,7 @@ size_t tm_align(shared_t shared) noexcept {
 **/
 tx_t tm_begin(shared_t unused(shared), bool is_ro) noexcept {
     // Write Transaction (1) 
-    Transaction* txn = new(nothrow) Transaction(gvc.load(),is_ro);
+    Transaction* txn = startTransaction(is_ro,false);
     if (!txn) return invalid_tx;
 
     return reinterpret_cast<tx_t>(txn);
@@ -129,6 +272,18 @@ bool tm_end(shared_t unused(shared), tx_t tx) noexcept {
     MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
     Transaction *txn = reinterpret_cast<Transaction*>(tx);
 
+    // An elastic transaction that never wrote commits like a read-only one: each of its reads was already checked against the window.
+    // Bumping the global version-clock for it would only make every concurrent committer validate its whole read-set.
+    if (txn->is_elastic && txn->write_set.empty()) {
+        if (!txn->seg_list.empty()) {
+            region->list_lock.lock();
+            region->seg_list.splice(region->seg_list.end(), txn->seg_list);
+            region->list_lock.unlock();
+        }
+        finishTransaction(txn,true);
+        return true;
+    }
+
     // Keep track of all the locks we are currently holding
     unordered_set<VersionedWriteLock*> locks_held;
 
@@ -140,14 +295,23 @@ bool tm_end(shared_t unused(shared), tx_t tx) noexcept {
         for (auto& keyval : txn->write_set) {
             char* target_addr = keyval.first;
             VersionedWriteLock* lock = &region->locks[(word)target_addr % NUM_LOCKS];
-            if (!lock->lock() && locks_held.find(lock) == locks_held.end()) {
+            bool acquired = lock->lock() || locks_held.find(lock) != locks_held.end();
+            if (!acquired && keyval.second->is_delta) {
+                // Increments commute, so a busy lock here is not a conflict: we wait for the other committer to write back and release it.
+                // Yielding between polls lets the holder run even when it shares our core, and the bound breaks waits between two committers.
+                for (size_t round = 0; !acquired && round < DELTA_LOCK_YIELDS; round++) {
+                    this_thread::yield();
+                    if (!lock->isLocked()) acquired = lock->lock();
+                }
+            }
+            if (!acquired) {
                 // Here we must delete all previously held locks and cleanup
                 for (auto lock : locks_held) {
                     lock->unlock();
                 }
-                delete txn;
-                return false;
+                return conflictAbort(txn,lock,target_addr);
             }
+            markLock(lock,target_addr);
             locks_held.insert(lock);
         }
         // Now we have every lock we need
@@ -169,10 +333,24 @@ bool tm_end(shared_t unused(shared), tx_t tx) noexcept {
                     for (auto lock : locks_held) {
                         lock->unlock();
                     }
-                    delete txn;
-                    return false;
+                    return conflictAbort(txn,lock,read);
                 }
             }   
+
+            // Same check for the ranges copied by tm_scan, which are kept as a whole instead of word by word
+            size_t word_size = tm_align(shared);
+            for (auto& range : txn->scans) {
+                for (size_t i = 0; i < range.size; i += word_size) {
+                    VersionedWriteLock* lock = &region->locks[(word)(range.start + i) % NUM_LOCKS];
+                    bool lock_owned = (locks_held.find(lock) != locks_held.end());
+                    if ((!lock_owned && lock->isLocked()) || lock->getVersion() > txn->rv) {
+                        for (auto lock : locks_held) {
+                            lock->unlock();
+                        }
+                        return conflictAbort(txn,lock,range.start + i);
+                    }
+                }
+            }
         }
 
         size_t word_size = tm_align(shared);
@@ -180,9 +358,9 @@ bool tm_end(shared_t unused(shared), tx_t tx) noexcept {
         // (6) Commit and release the locks
         for (auto& keyval : txn->write_set) {
             void* target_addr = keyval.first;
-            void* val = keyval.second->val;
 
-            memcpy(target_addr,val,word_size);
+            // Either copies the buffered value or adds the buffered increment
+            keyval.second->applyTo(target_addr,word_size);
             VersionedWriteLock* lock = &region->locks[(word)target_addr % NUM_LOCKS];
             // setVersion also unlocks the lock
             lock->setVersion(wv);
@@ -195,10 +373,29 @@ bool tm_end(shared_t unused(shared), tx_t tx) noexcept {
     }
 
     // Transaction successful, cleanup and return
-    delete txn;
+    finishTransaction(txn,true);
     return true;
 }
 
+// Copy one word for a write transaction, taking into account what the transaction already wrote there
+static inline void readThroughWriteSet(Transaction* txn, char* source_addr, char* target_addr, size_t word_size) {
+    // Check if the address was written to previously.
+    // This will determine if we need to read from the write set or the shared memory region
+    char* val_addr = nullptr;
+    bool is_delta = false;
+    auto it = txn->write_set.find(source_addr);
+    if (it != txn->write_set.end() && !it->second->is_delta) val_addr = (char*)it->second->val;
+    else {
+        val_addr = source_addr;
+        is_delta = (it != txn->write_set.end());
+    }
+
+    // We also copy the value directly. This technically breaks isolation, but we don't care since the value will be ignored if we later find out that the transaction must abort
+    memcpy(target_addr,val_addr,word_size);
+    // A pending increment is added on top of the shared value, which then has to be validated like any read
+    if (is_delta) it->second->applyTo(target_addr,word_size);
+}
+
 /** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
  * @param shared Shared memory region associated with the transaction
  * @param tx     Transaction to use
@@ -220,6 +417,7 @@ bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* ta
 
     if (txn->is_ro) {
         // Low-Cost Read-Only Transaction
+        txn->has_read = true;
         // (2) Run through a speculative execution
         for (size_t i = 0; i < size; i += word_size) {
             char* source_addr = source_start + i;
@@ -229,8 +427,7 @@ bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* ta
             VersionedWriteLock* lock = &region->locks[(word)source_addr % NUM_LOCKS];
             word version = lock->getVersion();
             if (lock->isLocked() || version > txn->rv) {
-                delete txn;
-                return false;
+                return conflictAbort(txn,lock,source_addr);
             }
 
             memcpy(target_addr,source_addr,word_size);
@@ -238,8 +435,7 @@ bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* ta
             // Post validate read
             word new_version = lock->getVersion();
             if (lock->isLocked() || new_version != version || new_version > txn->rv) {
-                delete txn;
-                return false;
+                return conflictAbort(txn,lock,source_addr);
             }
         }
     } else {
@@ -253,31 +449,53 @@ bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* ta
             // Get the lock which protects the address we want to read from.
             VersionedWriteLock* lock = &region->locks[(word)source_addr % NUM_LOCKS];
 
+            if (txn->is_elastic) {
+                // Elastic read: nothing is written yet, so this read only has to be consistent with the last ones
+                word version = lock->getVersion();
+                if (lock->isLocked()) {
+                    return conflictAbort(txn,lock,source_addr);
+                }
+                if (version > txn->rv) {
+                    // Instead of aborting, we try to move the snapshot forward.
+                    // This is only fine if the reads in the window were not overwritten in the meantime.
+                    auto now = gvc.load();
+                    for (size_t w = 0; w < txn->window_size; w++) {
+                        VersionedWriteLock* wlock = &region->locks[(word)txn->window[w].addr % NUM_LOCKS];
+                        if (wlock->isLocked() || wlock->getVersion() != txn->window[w].version) {
+                            return conflictAbort(txn,wlock,txn->window[w].addr);
+                        }
+                    }
+                    txn->rv = now;
+                }
+
+                memcpy(target_addr,source_addr,word_size);
+
+                // Post validate read
+                word new_version = lock->getVersion();
+                if (lock->isLocked() || new_version != version) {
+                    return conflictAbort(txn,lock,source_addr);
+                }
+
+                // The read is not added to the read-set, it only stays around until it is pushed out of the window
+                txn->pushElasticRead(source_addr, version);
+                continue;
+            }
+
             // Pre validate read
             word version = lock->getVersion();
             if (lock->isLocked() || version > txn->rv) {
                 //dprint2("Failed prevalidate HERE");
-                delete txn;
-                return false;
+                return conflictAbort(txn,lock,source_addr);
             }
 
             
-            // Check if the address was written to previously.
-            // This will determine if we need to read from the write set or the shared memory region
-            char* val_addr = nullptr;
-            auto it = txn->write_set.find(source_addr);
-            if (it != txn->write_set.end()) val_addr = (char*)it->second->val;
-            else val_addr = source_addr;
-
-            // We also copy the value directly. This technically breaks isolation, but we don't care since the value will be ignored if we later find out that the transaction must abort
-            memcpy(target_addr,val_addr,word_size);
+            readThroughWriteSet(txn,source_addr,target_addr,word_size);
 
             // Post validate read
             word new_version = lock->getVersion();
             if (lock->isLocked() || new_version != version) {
                 //dprint2("Failed postvalidate HERE");
-                delete txn;
-                return false;
+                return conflictAbort(txn,lock,source_addr);
             }
 
             // Keep track of all of the places we read from
@@ -307,6 +525,9 @@ bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* t
     // Invariant: size is a multiple of the alignment
     size_t word_size = tm_align(shared);
 
+    // The first write ends the elastic phase of the transaction
+    if (txn->is_elastic) txn->hardenElastic();
+
     // Go through every word we want to write to and add it to the write set
     for (size_t i = 0; i < size; i += word_size) {
         char* source_addr = source_start + i;
@@ -314,8 +535,45 @@ bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* t
 
         // Keep track of all of the places we will need to write to
         // This WriteOperation implicitly stores the value we want to write in dynamic memory, as we don't know how big it will be until the alignment is given.
-        txn->write_set.insert_or_assign(target_addr,make_unique<WriteOperation>(source_addr,word_size));
+        txn->write_set.insert_or_assign(target_addr,make_unique<WriteOperation>(source_addr,word_size,false,txn->pool));
+    }
+    return true;
+}
+
+/** [thread-safe] Increment operation in the given transaction, adding a delta to a word of the shared region.
+ * The word is not read, so concurrent increments of the same word do not conflict with each other: the delta is only applied at commit, under the word's lock.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Target word address (in the shared region), words must be 1, 2, 4 or 8 bytes wide
+ * @param delta  Signed increment, wrapping around like unsigned arithmetic on the word width
+ * @return Whether the whole transaction can continue
+**/
+bool tm_add(shared_t shared, tx_t tx, void* target, intptr_t delta) noexcept {
+    Transaction *txn = reinterpret_cast<Transaction*>(tx);
+    size_t word_size = tm_align(shared);
+
+    // There is no sensible integer addition for other word widths
+    if (unlikely(!isIntegerWord(word_size))) {
+        finishTransaction(txn,false);
+        return false;
+    }
+
+    // An increment counts as a write for the elastic phase
+    if (txn->is_elastic) txn->hardenElastic();
+
+    char* target_addr = (char*)(target);
+    auto it = txn->write_set.find(target_addr);
+    if (it != txn->write_set.end()) {
+        // Add on top of the value (or the increment) this transaction already wrote
+        it->second->accumulate(delta,word_size);
+        return true;
     }
+
+    // We start from a zero increment and add the delta to it
+    word zero[2] = {0, 0};
+    auto op = make_unique<WriteOperation>((char*)zero,word_size,true,txn->pool);
+    op->accumulate(delta,word_size);
+    txn->write_set.emplace(target_addr,move(op));
     return true;
 }
 
@@ -356,3 +614,360 @@ bool tm_free(shared_t unused(shared), tx_t unused(tx), void* unused(target)) noe
     // I did try other implementations where we would keep track of everything and have full open memory, but it slowed the implementation down a ton by having to lock global data structures.
     return true;
 }
+
+/** [thread-safe] Begin a new elastic read-write transaction on the given shared memory region.
+ * Until its first write, the reads of an elastic transaction only need to be consistent pairwise, so traversing a linked structure does not conflict with updates behind the traversal.
+ * @param shared Shared memory region to start a transaction on
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin_elastic(shared_t unused(shared)) noexcept {
+    Transaction* txn = startTransaction(false,true);
+    if (!txn) return invalid_tx;
+
+    return reinterpret_cast<tx_t>(txn);
+}
+
+/** [thread-safe] Early release of a range previously read in the given transaction.
+ * The released words are no longer validated at commit, so the caller must not depend on their value staying the same.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to release (in bytes), must be a positive multiple of the alignment
+ * @return Whether the whole transaction can continue
+**/
+bool tm_release(shared_t shared, tx_t tx, void const* source, size_t size) noexcept {
+    Transaction *txn = reinterpret_cast<Transaction*>(tx);
+
+    // Read-only transactions do not keep a read-set, there is nothing to release
+    if (txn->is_ro) return true;
+
+    char* source_start = (char*)(source);
+    size_t word_size = tm_align(shared);
+
+    for (size_t i = 0; i < size; i += word_size) {
+        char* source_addr = source_start + i;
+        txn->read_set.erase(source_addr);
+
+        // Also drop it from the elastic window so that it is not used to extend the snapshot
+        size_t kept = 0;
+        for (size_t w = 0; w < txn->window_size; w++) {
+            if (txn->window[w].addr != source_addr) txn->window[kept++] = txn->window[w];
+        }
+        txn->window_size = kept;
+    }
+    return true;
+}
+
+/** [thread-safe] Single-word transactional load, outside of any transaction.
+ * @param shared Shared memory region to read from
+ * @param source Source word address (in the shared region)
+ * @param target Target address (in a private region), receives one word
+ * @return Whether the load succeeded (always true, it retries until it gets a consistent value)
+**/
+bool tm_load(shared_t shared, void const* source, void* target) noexcept {
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+    VersionedWriteLock* lock = &region->locks[(word)source % NUM_LOCKS];
+
+    // Same pre/post validation as a transactional read, except that any version is fine since we have no snapshot to stick to
+    while (true) {
+        word version = lock->getVersion();
+        if (lock->isLocked()) {
+            this_thread::yield();
+            continue;
+        }
+        memcpy(target,source,word_size);
+        if (!lock->isLocked() && lock->getVersion() == version) return true;
+    }
+}
+
+/** [thread-safe] Single-word transactional store, outside of any transaction.
+ * Costs one lock acquisition and one global version-clock increment, and is seen by full transactions as a committed write transaction.
+ * @param shared Shared memory region to write to
+ * @param source Source address (in a private region), holding one word
+ * @param target Target word address (in the shared region)
+ * @return Whether the store succeeded (always true, it waits for the word's lock)
+**/
+bool tm_store(shared_t shared, void const* source, void* target) noexcept {
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+    VersionedWriteLock* lock = &region->locks[(word)target % NUM_LOCKS];
+
+    // We only ever hold this one lock, so waiting for it cannot deadlock
+    while (!lock->lock()) this_thread::yield();
+    markLock(lock,target);
+
+    // This is a commit with an empty read-set, so there is nothing to validate
+    version wv = gvc.fetch_add(1) + 1;
+    memcpy(target,source,word_size);
+    lock->setVersion(wv);
+    return true;
+}
+
+/** [thread-safe] Single-word transactional compare-and-swap, outside of any transaction.
+ * @param shared   Shared memory region to write to
+ * @param target   Target word address (in the shared region)
+ * @param expected Address (in a private region) of the expected word, receives the current word on failure
+ * @param desired  Address (in a private region) of the word to store if the current word is the expected one
+ * @return Whether the word was the expected one and got replaced
+**/
+bool tm_cas(shared_t shared, void* target, void* expected, void const* desired) noexcept {
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+    VersionedWriteLock* lock = &region->locks[(word)target % NUM_LOCKS];
+
+    while (!lock->lock()) this_thread::yield();
+
+    if (memcmp(target,expected,word_size) != 0) {
+        // Nothing changed, so we give the lock back without bumping its version
+        memcpy(expected,target,word_size);
+        lock->unlock();
+        return false;
+    }
+
+    markLock(lock,target);
+    version wv = gvc.fetch_add(1) + 1;
+    memcpy(target,desired,word_size);
+    lock->setVersion(wv);
+    return true;
+}
+
+/** [thread-safe] Vectored read operation in the given transaction, sources in the shared region and targets in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param vecs   Array of (source, size, target) reads, each size a positive multiple of the alignment
+ * @param count  Number of entries in the array
+ * @return Whether the whole transaction can continue
+**/
+bool tm_readv(shared_t shared, tx_t tx, tm_vec const* vecs, size_t count) noexcept {
+    Transaction *txn = reinterpret_cast<Transaction*>(tx);
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+
+    // Elastic reads are checked one after the other against the window, so batching them buys nothing
+    if (txn->is_elastic) {
+        for (size_t v = 0; v < count; v++) {
+            if (!tm_read(shared, tx, vecs[v].source, vecs[v].size, vecs[v].target)) return false;
+        }
+        return true;
+    }
+
+    // (1) Prefetch every lock word and data line first, so that the cache misses overlap instead of being paid one after the other
+    for (size_t v = 0; v < count; v++) {
+        char* source_start = (char*)(vecs[v].source);
+        for (size_t i = 0; i < vecs[v].size; i += word_size) {
+            prefetch(&region->locks[(word)(source_start + i) % NUM_LOCKS]);
+        }
+        for (size_t i = 0; i < vecs[v].size; i += CACHE_LINE) {
+            prefetch(source_start + i);
+        }
+    }
+
+    // (2) Pre validate all the stripes together, remembering the versions we saw
+    txn->versions.clear();
+    for (size_t v = 0; v < count; v++) {
+        char* source_start = (char*)(vecs[v].source);
+        for (size_t i = 0; i < vecs[v].size; i += word_size) {
+            VersionedWriteLock* lock = &region->locks[(word)(source_start + i) % NUM_LOCKS];
+            word version = lock->getVersion();
+            if (lock->isLocked() || version > txn->rv) {
+                return conflictAbort(txn,lock,source_start + i);
+            }
+            txn->versions.push_back(version);
+        }
+    }
+
+    // (3) Copy everything
+    if (txn->is_ro) txn->has_read = true;
+    for (size_t v = 0; v < count; v++) {
+        if (txn->is_ro) {
+            // Read-only transactions never read their own writes, so each entry is a single copy
+            memcpy(vecs[v].target,vecs[v].source,vecs[v].size);
+            continue;
+        }
+        char* source_start = (char*)(vecs[v].source);
+        char* target_start = (char*)(vecs[v].target);
+        for (size_t i = 0; i < vecs[v].size; i += word_size) {
+            readThroughWriteSet(txn,source_start + i,target_start + i,word_size);
+        }
+    }
+
+    // (4) Post validate all the stripes together, they must not have moved since (2)
+    size_t seen = 0;
+    for (size_t v = 0; v < count; v++) {
+        char* source_start = (char*)(vecs[v].source);
+        for (size_t i = 0; i < vecs[v].size; i += word_size) {
+            VersionedWriteLock* lock = &region->locks[(word)(source_start + i) % NUM_LOCKS];
+            if (lock->isLocked() || lock->getVersion() != txn->versions[seen++]) {
+                return conflictAbort(txn,lock,source_start + i);
+            }
+        }
+    }
+
+    // (5) Keep track of all of the places we read from
+    if (!txn->is_ro) {
+        for (size_t v = 0; v < count; v++) {
+            char* source_start = (char*)(vecs[v].source);
+            for (size_t i = 0; i < vecs[v].size; i += word_size) {
+                txn->read_set.insert(source_start + i);
+            }
+        }
+    }
+    return true;
+}
+
+/** [thread-safe] Vectored write operation in the given transaction, sources in a private region and targets in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param vecs   Array of (source, size, target) writes, each size a positive multiple of the alignment
+ * @param count  Number of entries in the array
+ * @return Whether the whole transaction can continue
+**/
+bool tm_writev(shared_t shared, tx_t tx, tm_vec const* vecs, size_t count) noexcept {
+    Transaction *txn = reinterpret_cast<Transaction*>(tx);
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+
+    if (txn->is_elastic) txn->hardenElastic();
+
+    for (size_t v = 0; v < count; v++) {
+        char* source_start = (char*)(vecs[v].source);
+        char* target_start = (char*)(vecs[v].target);
+        for (size_t i = 0; i < vecs[v].size; i += word_size) {
+            txn->write_set.insert_or_assign(target_start + i,make_unique<WriteOperation>(source_start + i,word_size,false,txn->pool));
+        }
+    }
+    return true;
+}
+
+// Outcome of copying one chunk of a scan
+enum class ChunkCopy {
+    copied,
+    // A stripe was locked by a committer, which may still release it unchanged
+    busy,
+    // A stripe was committed to after the snapshot of the transaction
+    newer
+};
+
+// Copy one chunk of a scan: sample every stripe covering it, copy it at once, then check that no stripe moved
+static inline ChunkCopy copyChunk(Transaction* txn, MemoryRegion* region, char* source, size_t size, char* target, size_t word_size, char*& conflict) {
+    txn->versions.clear();
+    for (size_t i = 0; i < size; i += word_size) {
+        VersionedWriteLock* lock = &region->locks[(word)(source + i) % NUM_LOCKS];
+        word version = lock->getVersion();
+        if (lock->isLocked() || version > txn->rv) {
+            conflict = source + i;
+            return lock->isLocked() ? ChunkCopy::busy : ChunkCopy::newer;
+        }
+        txn->versions.push_back(version);
+    }
+
+    memcpy(target,source,size);
+
+    for (size_t i = 0, seen = 0; i < size; i += word_size) {
+        VersionedWriteLock* lock = &region->locks[(word)(source + i) % NUM_LOCKS];
+        if (lock->isLocked() || lock->getVersion() != txn->versions[seen++]) {
+            conflict = source + i;
+            return lock->isLocked() ? ChunkCopy::busy : ChunkCopy::newer;
+        }
+    }
+    return ChunkCopy::copied;
+}
+
+// Move the snapshot of a scanning transaction forward, which is only fine if nothing it read so far was overwritten since
+static bool extendSnapshot(Transaction* txn, MemoryRegion* region, char* scanned, size_t size, size_t word_size) {
+    // Read-only transactions do not keep their reads around, so only one that read nothing but this scan can move
+    if (txn->is_ro && txn->has_read) return false;
+
+    auto current = [&](char* addr) {
+        VersionedWriteLock* lock = &region->locks[(word)addr % NUM_LOCKS];
+        return !lock->isLocked() && lock->getVersion() <= txn->rv;
+    };
+
+    // The clock is sampled first, so that any commit we miss below gets a later version than the new snapshot
+    auto now = gvc.load();
+    if (!txn->is_ro) {
+        for (auto& read : txn->read_set) {
+            if (!current(read)) return false;
+        }
+        for (auto& range : txn->scans) {
+            for (size_t i = 0; i < range.size; i += word_size) {
+                if (!current(range.start + i)) return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < size; i += word_size) {
+        if (!current(scanned + i)) return false;
+    }
+    txn->rv = now;
+    return true;
+}
+
+/** [thread-safe] Snapshot scan of a range in the given transaction, source in the shared region and target in a private region.
+ * Same result as 'tm_read', but the range is copied in chunks of SCAN_CHUNK bytes with one bulk copy each, between sampling and re-checking the stripes covering the chunk.
+ * A chunk that conflicts is copied again, after moving the snapshot forward if the transaction can still revalidate what it read; the chunks before it are kept.
+ * Write transactions keep the range as a whole instead of word by word in their read-set, so it cannot be released early.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_scan(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+    Transaction *txn = reinterpret_cast<Transaction*>(tx);
+    MemoryRegion* region = reinterpret_cast<MemoryRegion*>(shared);
+    size_t word_size = region->align;
+
+    // Elastic reads must go through the window one by one
+    if (txn->is_elastic) return tm_read(shared, tx, source, size, target);
+
+    char* source_start = (char*)(source);
+    char* target_start = (char*)(target);
+    // Whole words per chunk, in case the alignment does not divide it
+    size_t chunk = SCAN_CHUNK > word_size ? SCAN_CHUNK - SCAN_CHUNK % word_size : word_size;
+
+    for (size_t done = 0; done < size;) {
+        size_t length = size - done < chunk ? size - done : chunk;
+        for (size_t attempt = 0;; attempt++) {
+            char* conflict = nullptr;
+            ChunkCopy res = copyChunk(txn,region,source_start + done,length,target_start + done,word_size,conflict);
+            if (likely(res == ChunkCopy::copied)) break;
+            VersionedWriteLock* lock = &region->locks[(word)conflict % NUM_LOCKS];
+            if (attempt + 1 >= SCAN_RETRIES) return conflictAbort(txn,lock,conflict);
+            if (res == ChunkCopy::busy) {
+                // Give the committer holding the stripe a chance to finish
+                this_thread::yield();
+            } else if (!extendSnapshot(txn,region,source_start,done,word_size)) {
+                return conflictAbort(txn,lock,conflict);
+            }
+        }
+        done += length;
+    }
+
+    if (txn->is_ro) {
+        txn->has_read = true;
+        return true;
+    }
+
+    // Read our own writes: a buffered value replaces the copied word, a buffered increment is added to it.
+    // We walk whichever of the write-set and the range is smaller.
+    if (!txn->write_set.empty()) {
+        if (txn->write_set.size() < size / word_size) {
+            for (auto& keyval : txn->write_set) {
+                char* addr = keyval.first;
+                if (addr < source_start || addr >= source_start + size) continue;
+                keyval.second->applyTo(target_start + (addr - source_start),word_size);
+            }
+        } else {
+            for (size_t i = 0; i < size; i += word_size) {
+                auto it = txn->write_set.find(source_start + i);
+                if (it != txn->write_set.end()) it->second->applyTo(target_start + i,word_size);
+            }
+        }
+    }
+
+    // Keep track of the range for the commit-time validation
+    txn->scans.push_back(ScanRange{source_start, size});
+    return true;
+}
@@ -0,0 +1,284 @@
+/**
+ * @file   affinity.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Placement of the worker threads on the CPUs (Linux only), following the CPU topology from sysfs.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Affinity, Any, "thread placement exception");
+    EXCEPTION(AffinityUnsupported, Affinity, "thread placement is not supported on this platform");
+    EXCEPTION(AffinityEmpty, Affinity, "no usable CPU for the requested placement");
+    EXCEPTION(AffinitySet, Affinity, "unable to pin a worker thread");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** CPUs this process may run on, with their position in the machine.
+**/
+class Topology final {
+public:
+    /** One logical CPU.
+    **/
+    struct Cpu {
+        unsigned int id;      // Logical CPU number
+        unsigned int package; // Socket
+        unsigned int core;    // Physical core, within the socket
+        unsigned int smt;     // Rank among the hardware threads of the same core (0 for the first)
+    };
+private:
+    ::std::vector<Cpu> cpus; // Usable CPUs, by increasing id
+private:
+    /** Read a number from sysfs.
+     * @param path Path of the file
+     * @param def  Value if the file cannot be read
+     * @return Read value
+    **/
+    static unsigned int read_sysfs(::std::string const& path, unsigned int def) {
+        ::std::ifstream file{path};
+        unsigned int value;
+        if (!(file >> value))
+            return def;
+        return value;
+    }
+public:
+    /** Current process constructor, empty if the platform does not tell.
+    **/
+    Topology() {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (::sched_getaffinity(0, sizeof(set), &set) != 0)
+            return;
+        for (unsigned int id = 0; id < CPU_SETSIZE; ++id) {
+            if (!CPU_ISSET(id, &set))
+                continue;
+            auto base = "/sys/devices/system/cpu/cpu" + ::std::to_string(id) + "/topology/";
+            cpus.push_back(Cpu{id, read_sysfs(base + "physical_package_id", 0), read_sysfs(base + "core_id", id), 0});
+        }
+        for (auto&& cpu: cpus) { // Rank the hardware threads of each core by id
+            for (auto&& other: cpus) {
+                if (other.id < cpu.id && other.package == cpu.package && other.core == cpu.core)
+                    ++cpu.smt;
+            }
+        }
+#endif
+    }
+public:
+    /** Access the usable CPUs.
+     * @return Usable CPUs, by increasing id
+    **/
+    auto const& get_cpus() const noexcept {
+        return cpus;
+    }
+    /** Count the distinct packages.
+     * @return Number of packages
+    **/
+    size_t get_nbpackages() const {
+        ::std::vector<unsigned int> seen;
+        for (auto&& cpu: cpus) {
+            if (::std::find(seen.begin(), seen.end(), cpu.package) == seen.end())
+                seen.push_back(cpu.package);
+        }
+        return seen.size();
+    }
+    /** Count the physical cores.
+     * @return Number of cores
+    **/
+    size_t get_nbcores() const noexcept {
+        return static_cast<size_t>(::std::count_if(cpus.begin(), cpus.end(), [](Cpu const& cpu) { return cpu.smt == 0; }));
+    }
+};
+
+/** Placement policy of the worker threads.
+**/
+class Placement final {
+public:
+    /** Policy enum class.
+    **/
+    enum class Kind {
+        none,    // Let the scheduler decide
+        compact, // Fill the hardware threads of a core, then the cores of a package, then the next package
+        scatter, // Spread over the packages, then the cores, hardware threads of a same core last
+        nosmt,   // One hardware thread per core, packages filled one after the other
+        list     // Explicit list of CPUs
+    };
+private:
+    Kind kind; // Selected policy
+    ::std::vector<unsigned int> explicit_cpus; // CPUs of the 'list' policy
+public:
+    /** Default (no placement) constructor.
+    **/
+    Placement(): kind{Kind::none} {}
+public:
+    /** Select a policy from its name, or from a CPU list like "0,2,4-7".
+     * @param value Null-terminated policy name or CPU list
+     * @return Whether the value is valid
+    **/
+    bool parse(char const* value) {
+        static char const* const names[] = {"none", "compact", "scatter", "nosmt"};
+        for (size_t i = 0; i < sizeof(names) / sizeof(*names); ++i) {
+            if (::std::strcmp(value, names[i]) == 0) {
+                kind = static_cast<Kind>(i);
+                explicit_cpus.clear();
+                return true;
+            }
+        }
+        ::std::vector<unsigned int> cpus;
+        for (char const* cursor = value; *cursor != '\0';) {
+            char* end;
+            auto first = ::std::strtoul(cursor, &end, 10);
+            if (end == cursor)
+                return false;
+            auto last = first;
+            cursor = end;
+            if (*cursor == '-') {
+                last = ::std::strtoul(cursor + 1, &end, 10);
+                if (end == cursor + 1 || last < first)
+                    return false;
+                cursor = end;
+            }
+            for (auto cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(static_cast<unsigned int>(cpu));
+            if (*cursor == ',') {
+                ++cursor;
+            } else if (*cursor != '\0') {
+                return false;
+            }
+        }
+        if (cpus.empty())
+            return false;
+        kind = Kind::list;
+        explicit_cpus = ::std::move(cpus);
+        return true;
+    }
+    /** Tell whether the workers are to be pinned.
+     * @return Whether a policy other than 'none' is selected
+    **/
+    bool is_pinned() const noexcept {
+        return kind != Kind::none;
+    }
+    /** Get a printable name of the policy.
+     * @return Policy name, or the CPU list
+    **/
+    ::std::string get_name() const {
+        switch (kind) {
+        case Kind::none:
+            return "none";
+        case Kind::compact:
+            return "compact";
+        case Kind::scatter:
+            return "scatter";
+        case Kind::nosmt:
+            return "nosmt";
+        default: {
+            ::std::string res;
+            for (auto cpu: explicit_cpus)
+                res += (res.empty() ? "" : ",") + ::std::to_string(cpu);
+            return res;
+        }
+        }
+    }
+    /** Compute the CPU of every worker, wrapping around when there are more workers than CPUs.
+     * @param topology  Usable CPUs
+     * @param nbworkers Number of workers
+     * @return CPU of each worker, empty if not pinned
+    **/
+    ::std::vector<unsigned int> assign(Topology const& topology, size_t nbworkers) const {
+        if (kind == Kind::none)
+            return {};
+        ::std::vector<unsigned int> order;
+        if (kind == Kind::list) {
+            order = explicit_cpus;
+        } else {
+            auto cpus = topology.get_cpus();
+            if (kind == Kind::nosmt)
+                cpus.erase(::std::remove_if(cpus.begin(), cpus.end(), [](Topology::Cpu const& cpu) { return cpu.smt > 0; }), cpus.end());
+            if (kind == Kind::scatter) {
+                // Rank of each core within its package, so that consecutive workers land on different packages
+                ::std::vector<unsigned int> ranks(cpus.size(), 0);
+                for (size_t i = 0; i < cpus.size(); ++i) {
+                    for (auto&& other: cpus) {
+                        if (other.smt == 0 && other.package == cpus[i].package && other.core < cpus[i].core)
+                            ++ranks[i];
+                    }
+                }
+                ::std::vector<size_t> index(cpus.size());
+                for (size_t i = 0; i < index.size(); ++i)
+                    index[i] = i;
+                ::std::stable_sort(index.begin(), index.end(), [&](size_t a, size_t b) {
+                    if (cpus[a].smt != cpus[b].smt)
+                        return cpus[a].smt < cpus[b].smt;
+                    if (ranks[a] != ranks[b])
+                        return ranks[a] < ranks[b];
+                    return cpus[a].package < cpus[b].package;
+                });
+                for (auto i: index)
+                    order.push_back(cpus[i].id);
+            } else {
+                ::std::stable_sort(cpus.begin(), cpus.end(), [](Topology::Cpu const& a, Topology::Cpu const& b) {
+                    if (a.package != b.package)
+                        return a.package < b.package;
+                    if (a.core != b.core)
+                        return a.core < b.core;
+                    return a.smt < b.smt;
+                });
+                for (auto&& cpu: cpus)
+                    order.push_back(cpu.id);
+            }
+        }
+        if (unlikely(order.empty()))
+            throw Exception::AffinityEmpty{};
+        ::std::vector<unsigned int> res(nbworkers);
+        for (size_t i = 0; i < nbworkers; ++i)
+            res[i] = order[i % order.size()];
+        return res;
+    }
+    /** Pin a thread to one CPU.
+     * @param thread Thread to pin
+     * @param cpu    CPU to run it on
+    **/
+    static void pin(::std::thread& thread, unsigned int cpu) {
+#if defined(__linux__)
+        if (unlikely(cpu >= CPU_SETSIZE))
+            throw Exception::AffinitySet{};
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (unlikely(::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0))
+            throw Exception::AffinitySet{};
+#else
+        (void) thread;
+        (void) cpu;
+        throw Exception::AffinityUnsupported{};
+#endif
+    }
+};
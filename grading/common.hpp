@@ -29,12 +29,18 @@
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <mutex>
 #include <thread>
 #include <utility>
 extern "C" {
 #include <time.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 }
 
 // -------------------------------------------------------------------------- //
@@ -262,17 +268,103 @@ static void short_pause() {
 #endif
 }
 
+/** Waiting policy of the harness' own synchronization ('Sync', 'Barrier'), so that idle threads do not compete with the measured ones.
+**/
+class Waiting final {
+public:
+    /** Policy enum class.
+    **/
+    enum class Policy {
+        spin, // Spin on 'short_pause' until the value changes
+        futex // Spin a little, then sleep in the kernel (Linux only, spin elsewhere)
+    };
+private:
+    static Policy policy; // Current policy
+    constexpr static unsigned int nbspins = 1024; // Number of pauses before sleeping, with 'Policy::futex'
+private:
+    /** Get the futex word of an atomic variable.
+     * @param word Atomic variable, 32 bits wide
+     * @return Futex word address
+    **/
+    template<class Value> static auto address(::std::atomic<Value> const& word) noexcept {
+        static_assert(sizeof(word) == sizeof(uint32_t) && ::std::atomic<Value>::is_always_lock_free, "Futex words are lock-free 32-bit integers");
+        return reinterpret_cast<uint32_t*>(const_cast<::std::atomic<Value>*>(&word));
+    }
+    /** Get the futex value of a value.
+     * @param value Value to convert
+     * @return Futex value
+    **/
+    template<class Value> static uint32_t bits(Value value) noexcept {
+        uint32_t res;
+        ::std::memcpy(&res, &value, sizeof(res));
+        return res;
+    }
+public:
+    /** Set the policy, before any thread waits.
+     * @param value Policy to use
+    **/
+    static void set_policy(Policy value) noexcept {
+        policy = value;
+    }
+    /** Get the name of the policy actually used.
+     * @return Null-terminated name
+    **/
+    static char const* get_name() noexcept {
+#ifdef __linux__
+        if (policy == Policy::futex)
+            return "spin-then-futex";
+#endif
+        return "spin";
+    }
+    /** Wait for an atomic variable to (probably) change from the given value, callers reload and check it.
+     * @param word  Atomic variable to watch, 32 bits wide
+     * @param value Value it had
+    **/
+    template<class Value> static void wait(::std::atomic<Value> const& word, Value value) noexcept {
+#ifdef __linux__
+        if (policy == Policy::futex) {
+            for (unsigned int i = 0; i < nbspins; ++i) {
+                if (word.load(::std::memory_order_relaxed) != value)
+                    return;
+                short_pause();
+            }
+            ::syscall(SYS_futex, address(word), FUTEX_WAIT_PRIVATE, bits(value), nullptr, nullptr, 0); // Returns at once if the value already changed
+            return;
+        }
+#endif
+        (void) word;
+        (void) value;
+        short_pause();
+    }
+    /** Wake all the threads waiting on an atomic variable, after changing it.
+     * @param word Atomic variable that changed, 32 bits wide
+    **/
+    template<class Value> static void wake(::std::atomic<Value> const& word) noexcept {
+#ifdef __linux__
+        if (policy == Policy::futex)
+            ::syscall(SYS_futex, address(word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+        (void) word;
+    }
+};
+inline Waiting::Policy Waiting::policy = Waiting::Policy::spin;
+
 /** Run some function for some bounded time, throws 'Exception::BoundedOverrun' on overtime.
  * @param dur  Maximum execution duration
- * @param func Function to run (void -> void)
+ * @param func Function to run (void -> void), any exception it throws is rethrown in the caller
  * @param emsg Null-terminated error message
 **/
 template<class Rep, class Period, class Func> static void bounded_run(::std::chrono::duration<Rep, Period> const& dur, Func&& func, char const* emsg) {
     ::std::mutex lock;
     ::std::unique_lock<decltype(lock)> guard{lock};
     ::std::condition_variable cv;
+    ::std::exception_ptr error;
     ::std::thread runner{[&]() {
-        func();
+        try {
+            func();
+        } catch (...) {
+            error = ::std::current_exception();
+        }
         { // Notify master
             ::std::unique_lock<decltype(lock)> guard{lock};
             cv.notify_all();
@@ -283,9 +375,11 @@ template<class Rep, class Period, class Func> static void bounded_run(::std::chr
         throw Exception::BoundedOverrun{emsg};
     }
     runner.join();
+    if (error)
+        ::std::rethrow_exception(error);
 }
 
-/** Spin barrier class.
+/** Barrier class, waiting according to 'Waiting'.
 **/
 class Barrier final {
 public:
@@ -318,16 +412,18 @@ public:
         // Enter
         if (step.fetch_add(1, ::std::memory_order_relaxed) + 1 == cardinal) { // Set leave mode
             mode.store(Mode::leave, ::std::memory_order_release);
+            Waiting::wake(mode);
         } else { // Wait for leave mode
             while (unlikely(mode.load(::std::memory_order_acquire) != Mode::leave))
-                short_pause();
+                Waiting::wait(mode, Mode::enter);
         }
         // Leave
         if (step.fetch_sub(1, ::std::memory_order_relaxed) - 1 == 0) { // Set enter mode
             mode.store(Mode::enter, ::std::memory_order_release);
+            Waiting::wake(mode);
         } else { // Wait for enter mode
             while (unlikely(mode.load(::std::memory_order_acquire) != Mode::enter))
-                short_pause();
+                Waiting::wait(mode, Mode::leave);
         }
     }
 };
@@ -0,0 +1,142 @@
+/**
+ * @file   compare.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Comparison of throughput samples against a baseline, with bootstrap confidence intervals.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "report.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Ratio of the median throughputs of two sets of samples, with its bootstrap confidence interval.
+**/
+class Comparison final {
+public:
+    double ratio; // Median of the new samples over the median of the baseline ones
+    double low;   // Lower bound of the confidence interval of the ratio
+    double high;  // Upper bound of the confidence interval of the ratio
+private:
+    /** Get the median of a set of samples.
+     * @param samples Non-empty set of samples (reordered)
+     * @return Median, same position as 'Summary'
+    **/
+    static double median(::std::vector<double>& samples) {
+        auto middle = samples.begin() + static_cast<ptrdiff_t>(samples.size() / 2);
+        ::std::nth_element(samples.begin(), middle, samples.end());
+        return *middle;
+    }
+public:
+    /** Percentile bootstrap constructor.
+     * @param baseline    Non-empty baseline samples
+     * @param samples     Non-empty new samples
+     * @param confidence  Confidence level of the interval, in (0, 1)
+     * @param nbresamples Number of bootstrap resamples
+     * @param seed        Seed of the resampling
+    **/
+    Comparison(::std::vector<double> baseline, ::std::vector<double> samples, double confidence, size_t nbresamples, uint_fast32_t seed) {
+        ::std::vector<double> old_draw(baseline.size());
+        ::std::vector<double> new_draw(samples.size());
+        ::std::vector<double> ratios(nbresamples);
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> pick_old{0, baseline.size() - 1};
+        ::std::uniform_int_distribution<size_t> pick_new{0, samples.size() - 1};
+        for (auto&& value: ratios) { // Resample both sides independently, with replacement
+            for (auto&& draw: old_draw)
+                draw = baseline[pick_old(engine)];
+            for (auto&& draw: new_draw)
+                draw = samples[pick_new(engine)];
+            value = median(new_draw) / median(old_draw);
+        }
+        ::std::sort(ratios.begin(), ratios.end());
+        auto at = [&](double quantile) {
+            auto pos = static_cast<size_t>(quantile * static_cast<double>(nbresamples - 1) + 0.5);
+            return ratios[::std::min(pos, nbresamples - 1)];
+        };
+        low   = at((1. - confidence) / 2.);
+        high  = at((1. + confidence) / 2.);
+        ratio = median(samples) / median(baseline);
+    }
+public:
+    /** Tell whether the new samples are significantly slower.
+     * @param tolerance Relative slowdown to tolerate, in [0, 1)
+     * @return Whether the whole interval is below '1 - tolerance'
+    **/
+    bool is_slowdown(double tolerance) const noexcept {
+        return high < 1. - tolerance;
+    }
+};
+
+/** Fields identifying a measurement: library, workload, bank variant, shape and thread count.
+**/
+static char const* const measurement_keys[] = {"library", "workload", "skew", "scan", "region_bytes", "tx_reads", "tx_writes", "threads"};
+/** Fields of the configuration a measurement ran with, its throughput is only comparable with the same values.
+**/
+static char const* const setting_keys[] = {"accounts", "expected_accounts", "init_balance", "prob_long", "prob_alloc", "zipf_theta", "hot_fraction", "hot_prob", "keys", "prob_update", "tx_per_worker", "duration_ms", "placement", "waiting", "cpus"};
+
+/** Tell whether two records have the same value for a field, or both lack it.
+ * @param a   First record
+ * @param b   Second record
+ * @param key Field name
+ * @return Whether they agree on the field
+**/
+static bool same_field(Record const& a, Record const& b, char const* key) {
+    auto first = a.get(key);
+    auto second = b.get(key);
+    return (first == nullptr) == (second == nullptr) && (!first || *first == *second);
+}
+
+/** Find the record of the same measurement, run with the same configuration, in a baseline report.
+ * @param baseline Baseline report
+ * @param record   Record to match, on all its measurement and setting fields
+ * @param differs  Set to the first setting field that differs, if a record of the same measurement was found but with another configuration
+ * @return Matching baseline record, 'nullptr' if none
+**/
+static Record const* find_baseline(Report const& baseline, Record const& record, ::std::string& differs) {
+    for (auto&& candidate: baseline.get_records()) {
+        auto same = ::std::all_of(::std::begin(measurement_keys), ::std::end(measurement_keys), [&](char const* key) { return same_field(record, candidate, key); });
+        if (!same)
+            continue;
+        auto setting = ::std::find_if(::std::begin(setting_keys), ::std::end(setting_keys), [&](char const* key) { return !same_field(record, candidate, key); });
+        if (setting == ::std::end(setting_keys))
+            return &candidate;
+        if (differs.empty())
+            differs = *setting;
+    }
+    return nullptr;
+}
+
+/** Parse a space-separated list of samples, as stored in the reports.
+ * @param value Field value
+ * @return Samples (empty if the field is not a list)
+**/
+static ::std::vector<double> parse_samples(Record::Value const* value) {
+    ::std::vector<double> res;
+    if (!value || !::std::holds_alternative<::std::string>(*value))
+        return res;
+    ::std::istringstream text{::std::get<::std::string>(*value)};
+    text.imbue(::std::locale::classic());
+    double sample;
+    while (text >> sample)
+        res.push_back(sample);
+    return res;
+}
@@ -0,0 +1,526 @@
+/**
+ * @file   config.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Run parameters of the grading tool, from the command line and/or a configuration file.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Internal headers
+#include "affinity.hpp"
+#include "common.hpp"
+#include "report.hpp"
+#include "workload.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Config, Any, "configuration exception");
+    EXCEPTION(ConfigUnknown, Config, "unknown option");
+    EXCEPTION(ConfigValue, Config, "invalid option value");
+    EXCEPTION(ConfigMissing, Config, "missing option value");
+    EXCEPTION(ConfigFile, Config, "unable to read the configuration file");
+    EXCEPTION(ConfigUsage, Config, "missing seed or library path");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** Run parameters class.
+**/
+class Config final {
+public:
+    /** Shape of the workload at one measurement, for the workloads evaluated at several shapes.
+    **/
+    struct Shape {
+        size_t region; // Size of the shared memory region (in MiB), for 'region' and 'txsize'
+        size_t reads;  // Number of words read per transaction, for 'txsize'
+        size_t writes; // Number of words written per transaction, for 'txsize'
+    };
+public:
+    size_t nbworkers;     // Number of worker threads
+    size_t nbtx;          // Total number of transactions, split among the workers (ignored if 'nbtxperwrk' is set)
+    size_t nbtxperwrk;    // Number of transactions per worker (0 to derive it from 'nbtx')
+    size_t nbaccounts;    // Initial number of accounts, per worker
+    size_t expnbaccounts; // Expected number of accounts, per worker
+    size_t init_balance;  // Initial account balance
+    float  prob_long;     // Probability of running a long, read-only control transaction
+    float  prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+    size_t nbrepeats;     // Number of repetitions (keep the median)
+    size_t nbwarmups;     // Number of discarded repetitions, before the measured ones
+    unsigned long seed;   // Seed for performance measurements
+    bool   has_seed;      // Whether the seed was given as an option (otherwise it is the first positional argument)
+    size_t slow_factor;   // How many times slower than the reference a library may be before timing out
+    ::std::string workload; // Name of the workload to run
+    Skew::Kind skew;      // Distribution of the accounts of the bank short transactions
+    double zipf_theta;    // Zipf exponent, for the 'zipf' distribution
+    double hot_fraction;  // Fraction of the accounts in the hot set, for the 'hotset' distribution
+    double hot_prob;      // Probability of choosing in the hot set, for the 'hotset' distribution
+    bool   scan;          // Whether the bank long transactions read each segment of accounts at once, with 'tm_scan' if exported
+    size_t nbkeys;        // Number of distinct keys (or resources) of the non-bank workloads
+    float  prob_update;   // Probability of running an updating transaction in the non-bank workloads
+    ::std::vector<size_t> region_sizes; // Increasing sizes of the shared memory region of the 'region' and 'txsize' workloads (in MiB)
+    size_t max_reads;     // Largest number of words read per transaction of a 1, 2, 4, ... sweep, for 'txsize'
+    size_t max_writes;    // Largest number of words written per transaction of a 0, 1, 2, 4, ... sweep, for 'txsize'
+    size_t duration;      // Duration of each repetition (in ms), 0 to run a fixed number of transactions instead
+    size_t interval;      // Period at which the transactions are counted in time-bounded repetitions (in ms)
+    bool   latency;       // Whether to record per-transaction latencies
+    bool   counters;      // Whether to read the hardware performance counters around the performance measurements
+    Placement placement;  // Placement policy of the worker threads
+    Waiting::Policy waiting; // How the harness threads wait for each other
+    bool   isolate;       // Whether to evaluate each library, at each thread count and shape, in a forked process
+    size_t isolate_timeout; // Time an isolated evaluation may take before it gets killed (in s)
+    ::std::string baseline; // Path of the JSON report to compare against, empty for none
+    double confidence;    // Confidence level of the intervals of the baseline comparison
+    double tolerance;     // Relative slowdown against the baseline tolerated before failing
+    bool   memory;        // Whether to count the heap allocations and sample the peak RSS (the hooks run on every 'malloc' and 'free', library included)
+    double mem_tolerance; // Relative growth of the heap bytes per transaction and of the peak RSS against the baseline tolerated before failing
+    size_t sweep;         // Largest number of threads of a 1, 2, 4, ... sweep (0 for no sweep, only 'nbworkers')
+    ::std::vector<size_t> oversubscribe; // Increasing multiples of the available CPUs to run as many workers, from 1 (empty for none)
+    Report::Format format; // Format of the machine-readable report
+    ::std::string output;  // Path of the machine-readable report, '-' for the standard output
+    ::std::vector<::std::string> libraries; // Paths of the libraries to evaluate, the reference first
+    ::std::string culprit; // Option that could not be parsed, if any
+    bool help;             // Whether the usage was asked for, in which case nothing else is parsed
+public:
+    /** Default parameters constructor.
+    **/
+    Config(): nbworkers{default_nbworkers()}, nbtx{200000}, nbtxperwrk{0}, nbaccounts{32}, expnbaccounts{256}, init_balance{100}, prob_long{0.5f}, prob_alloc{0.01f}, nbrepeats{7}, nbwarmups{0}, seed{0}, has_seed{false}, slow_factor{16}, workload{"bank"}, skew{Skew::Kind::uniform}, zipf_theta{0.99}, hot_fraction{0.1}, hot_prob{0.9}, scan{false}, nbkeys{1024}, prob_update{0.2f}, region_sizes{256}, max_reads{64}, max_writes{16}, duration{0}, interval{100}, latency{false}, counters{false}, waiting{Waiting::Policy::spin}, isolate{false}, isolate_timeout{600}, confidence{0.95}, tolerance{0.}, memory{false}, mem_tolerance{0.1}, sweep{0}, format{Report::Format::none}, output{"-"}, help{false} {}
+private:
+    /** Default number of worker threads.
+     * @return Number of hardware threads, or 16 if unknown
+    **/
+    static size_t default_nbworkers() noexcept {
+        auto res = ::std::thread::hardware_concurrency();
+        if (unlikely(res == 0))
+            res = 16;
+        return static_cast<size_t>(res);
+    }
+    /** Parse a non-negative integer.
+     * @param value Null-terminated string to parse
+     * @return Parsed value
+    **/
+    static size_t parse_size(char const* value) {
+        char* end;
+        auto res = ::std::strtoull(value, &end, 0);
+        if (unlikely(*value == '\0' || *value == '-' || *end != '\0'))
+            throw Exception::ConfigValue{};
+        return static_cast<size_t>(res);
+    }
+    /** Parse a probability.
+     * @param value Null-terminated string to parse
+     * @return Parsed value, in [0, 1]
+    **/
+    static float parse_prob(char const* value) {
+        char* end;
+        auto res = ::std::strtof(value, &end);
+        if (unlikely(*value == '\0' || *end != '\0' || !(res >= 0.f && res <= 1.f)))
+            throw Exception::ConfigValue{};
+        return res;
+    }
+    /** Parse a switch.
+     * @param value Null-terminated string to parse
+     * @return Parsed value
+    **/
+    static bool parse_bool(char const* value) {
+        for (auto yes: {"1", "on", "yes", "true"}) {
+            if (::std::strcmp(value, yes) == 0)
+                return true;
+        }
+        for (auto no: {"0", "off", "no", "false"}) {
+            if (::std::strcmp(value, no) == 0)
+                return false;
+        }
+        throw Exception::ConfigValue{};
+    }
+    /** Check a workload name.
+     * @param name Null-terminated name to check
+     * @return Whether the grading tool knows this workload
+    **/
+    static bool is_workload(char const* name) noexcept {
+        for (auto known: {"bank", "list", "hashmap", "rbtree", "vacation", "kmeans", "region", "txsize"}) {
+            if (::std::strcmp(name, known) == 0)
+                return true;
+        }
+        return false;
+    }
+    /** Set one parameter.
+     * @param key   Name of the parameter (without the leading '--')
+     * @param value Null-terminated value
+    **/
+    void set(::std::string const& key, char const* value) {
+        culprit = key;
+        if (key == "threads") {
+            nbworkers = parse_size(value);
+            if (unlikely(nbworkers == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "tx") {
+            nbtx = parse_size(value);
+        } else if (key == "tx-per-worker") {
+            nbtxperwrk = parse_size(value);
+        } else if (key == "accounts") {
+            nbaccounts = parse_size(value);
+            if (unlikely(nbaccounts == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "expected-accounts") {
+            expnbaccounts = parse_size(value);
+        } else if (key == "balance") {
+            init_balance = parse_size(value);
+        } else if (key == "prob-long") {
+            prob_long = parse_prob(value);
+        } else if (key == "prob-alloc") {
+            prob_alloc = parse_prob(value);
+        } else if (key == "repeats") {
+            nbrepeats = parse_size(value);
+            if (unlikely(nbrepeats == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "seed") {
+            seed = parse_size(value);
+            has_seed = true;
+        } else if (key == "slow-factor") {
+            slow_factor = parse_size(value);
+            if (unlikely(slow_factor == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "workload") {
+            if (unlikely(!is_workload(value)))
+                throw Exception::ConfigValue{};
+            workload = value;
+        } else if (key == "skew") {
+            if (::std::strcmp(value, "uniform") == 0) {
+                skew = Skew::Kind::uniform;
+            } else if (::std::strcmp(value, "zipf") == 0) {
+                skew = Skew::Kind::zipf;
+            } else if (::std::strcmp(value, "hotset") == 0) {
+                skew = Skew::Kind::hotset;
+            } else {
+                throw Exception::ConfigValue{};
+            }
+        } else if (key == "scan") {
+            scan = parse_bool(value);
+        } else if (key == "zipf-theta") {
+            zipf_theta = parse_prob(value);
+            if (unlikely(zipf_theta >= 1.))
+                throw Exception::ConfigValue{};
+        } else if (key == "hot-fraction") {
+            hot_fraction = parse_prob(value);
+        } else if (key == "hot-prob") {
+            hot_prob = parse_prob(value);
+        } else if (key == "keys") {
+            nbkeys = parse_size(value);
+            if (unlikely(nbkeys == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "prob-update") {
+            prob_update = parse_prob(value);
+        } else if (key == "region-mb") {
+            region_sizes.clear();
+            ::std::string list{value};
+            for (size_t start = 0; start <= list.size();) {
+                auto stop = list.find(',', start);
+                if (stop == ::std::string::npos)
+                    stop = list.size();
+                auto size = parse_size(list.substr(start, stop - start).c_str());
+                if (unlikely(size == 0 || size > (SIZE_MAX >> 20)))
+                    throw Exception::ConfigValue{};
+                region_sizes.push_back(size);
+                start = stop + 1;
+            }
+            ::std::sort(region_sizes.begin(), region_sizes.end());
+            region_sizes.erase(::std::unique(region_sizes.begin(), region_sizes.end()), region_sizes.end());
+        } else if (key == "tx-reads") {
+            max_reads = parse_size(value);
+            if (unlikely(max_reads == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "tx-writes") {
+            max_writes = parse_size(value);
+        } else if (key == "duration") {
+            duration = parse_size(value);
+        } else if (key == "interval") {
+            interval = parse_size(value);
+            if (unlikely(interval == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "latency") {
+            latency = parse_bool(value);
+        } else if (key == "counters") {
+            counters = parse_bool(value);
+        } else if (key == "warmup") {
+            nbwarmups = parse_size(value);
+        } else if (key == "baseline") {
+            baseline = value;
+        } else if (key == "confidence") {
+            confidence = parse_prob(value);
+            if (unlikely(confidence <= 0. || confidence >= 1.))
+                throw Exception::ConfigValue{};
+        } else if (key == "tolerance") {
+            tolerance = parse_prob(value);
+            if (unlikely(tolerance >= 1.))
+                throw Exception::ConfigValue{};
+        } else if (key == "memory") {
+            memory = parse_bool(value);
+        } else if (key == "mem-tolerance") {
+            mem_tolerance = parse_prob(value);
+        } else if (key == "pin") {
+            if (unlikely(!placement.parse(value)))
+                throw Exception::ConfigValue{};
+        } else if (key == "wait") {
+            if (::std::strcmp(value, "spin") == 0) {
+                waiting = Waiting::Policy::spin;
+            } else if (::std::strcmp(value, "futex") == 0) {
+                waiting = Waiting::Policy::futex;
+            } else {
+                throw Exception::ConfigValue{};
+            }
+        } else if (key == "isolate") {
+            isolate = parse_bool(value);
+        } else if (key == "isolate-timeout") {
+            isolate_timeout = parse_size(value);
+            if (unlikely(isolate_timeout == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "oversubscribe") {
+            oversubscribe = {1};
+            ::std::string list{value};
+            for (size_t start = 0; start <= list.size();) {
+                auto stop = list.find(',', start);
+                if (stop == ::std::string::npos)
+                    stop = list.size();
+                auto factor = parse_size(list.substr(start, stop - start).c_str());
+                if (unlikely(factor == 0))
+                    throw Exception::ConfigValue{};
+                oversubscribe.push_back(factor);
+                start = stop + 1;
+            }
+            ::std::sort(oversubscribe.begin(), oversubscribe.end());
+            oversubscribe.erase(::std::unique(oversubscribe.begin(), oversubscribe.end()), oversubscribe.end());
+        } else if (key == "sweep") {
+            sweep = parse_size(value);
+            if (unlikely(sweep == 0))
+                throw Exception::ConfigValue{};
+        } else if (key == "format") {
+            if (::std::strcmp(value, "csv") == 0) {
+                format = Report::Format::csv;
+            } else if (::std::strcmp(value, "json") == 0) {
+                format = Report::Format::json;
+            } else {
+                throw Exception::ConfigValue{};
+            }
+        } else if (key == "output") {
+            output = value;
+            if (format == Report::Format::none) { // Guess from the extension, until told otherwise
+                auto json = output.size() >= 5 && output.compare(output.size() - 5, 5, ".json") == 0;
+                format = json ? Report::Format::json : Report::Format::csv;
+            }
+        } else if (key == "config") {
+            load(value);
+        } else {
+            throw Exception::ConfigUnknown{};
+        }
+        culprit.clear();
+    }
+    /** Load a configuration file, made of 'key = value' lines ('#' starts a comment).
+     * @param path Path to the configuration file
+    **/
+    void load(char const* path) {
+        ::std::ifstream file{path};
+        if (unlikely(!file))
+            throw Exception::ConfigFile{};
+        ::std::string line;
+        while (::std::getline(file, line)) {
+            auto hash = line.find('#');
+            if (hash != ::std::string::npos)
+                line.erase(hash);
+            auto equal = line.find('=');
+            auto trim = [](::std::string text) {
+                auto first = text.find_first_not_of(" \t\r");
+                if (first == ::std::string::npos)
+                    return ::std::string{};
+                return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+            };
+            if (equal == ::std::string::npos) {
+                if (unlikely(!trim(line).empty())) { // Neither blank nor a comment
+                    culprit = trim(line);
+                    throw Exception::ConfigMissing{};
+                }
+                continue;
+            }
+            auto key = trim(line.substr(0, equal));
+            set(key, trim(line.substr(equal + 1)).c_str());
+        }
+    }
+public:
+    /** Parse the command line, options may come in any order with respect to the library paths.
+     * @param argc Arguments count
+     * @param argv Arguments values
+    **/
+    void parse(int argc, char** argv) {
+        ::std::vector<char const*> positionals;
+        for (auto i = 1; i < argc; ++i) {
+            if (::std::strcmp(argv[i], "--help") == 0 || ::std::strcmp(argv[i], "-h") == 0) { // A flag, whatever comes around it
+                help = true;
+                return;
+            }
+        }
+        for (auto i = 1; i < argc; ++i) {
+            if (::std::strncmp(argv[i], "--", 2) != 0) {
+                positionals.push_back(argv[i]);
+                continue;
+            }
+            ::std::string key{argv[i] + 2};
+            auto equal = key.find('=');
+            if (equal != ::std::string::npos) { // '--key=value'
+                set(key.substr(0, equal), argv[i] + 2 + equal + 1);
+            } else { // '--key value'
+                if (unlikely(i + 1 >= argc)) {
+                    culprit = key;
+                    throw Exception::ConfigMissing{};
+                }
+                set(key, argv[++i]);
+            }
+        }
+        // Without a '--seed' option, the seed is the first positional argument (original command line)
+        auto first = positionals.begin();
+        if (!has_seed) {
+            if (unlikely(first == positionals.end()))
+                throw Exception::ConfigUsage{};
+            culprit = "seed";
+            seed = parse_size(*first++);
+            culprit.clear();
+        }
+        libraries.assign(first, positionals.end());
+        if (unlikely(libraries.empty()))
+            throw Exception::ConfigUsage{};
+    }
+    /** Get the number of transactions each worker runs.
+     * @param nbthreads Number of worker threads
+     * @return Number of transactions per worker
+    **/
+    size_t get_txperworker(size_t nbthreads) const noexcept {
+        if (nbtxperwrk > 0)
+            return nbtxperwrk;
+        auto res = nbtx / nbthreads;
+        return res > 0 ? res : 1;
+    }
+    /** Get the distribution of the accounts of the bank short transactions.
+     * @return Account distribution
+    **/
+    Skew get_skew() const noexcept {
+        return Skew{skew, zipf_theta, hot_fraction, hot_prob};
+    }
+    /** Get 1, 2, 4, ... up to (and including) a given number.
+     * @param max Non-null largest number
+     * @return Increasing numbers
+    **/
+    static ::std::vector<size_t> get_powers(size_t max) {
+        ::std::vector<size_t> res;
+        for (size_t count = 1; count < max; count *= 2)
+            res.push_back(count);
+        res.push_back(max);
+        return res;
+    }
+    /** Get the shapes of the workload to evaluate at each thread count.
+     * @return Every region size for 'region', every region size, number of reads and number of writes for 'txsize', a single (unused) shape otherwise
+    **/
+    ::std::vector<Shape> get_shapes() const {
+        ::std::vector<Shape> res;
+        if (workload == "region") {
+            for (auto size: region_sizes)
+                res.push_back(Shape{size, 0, 0});
+        } else if (workload == "txsize") {
+            ::std::vector<size_t> writes{0}; // Read-only first
+            if (max_writes > 0) {
+                auto more = get_powers(max_writes);
+                writes.insert(writes.end(), more.begin(), more.end());
+            }
+            for (auto size: region_sizes) {
+                for (auto reads: get_powers(max_reads)) {
+                    for (auto count: writes)
+                        res.push_back(Shape{size, reads, count});
+                }
+            }
+        } else {
+            res.push_back(Shape{0, 0, 0});
+        }
+        return res;
+    }
+    /** Get the numbers of worker threads to evaluate.
+     * @param nbcpus Number of CPUs the workers may run on, 0 if unknown
+     * @return The 'oversubscribe' multiples of 'nbcpus', or 'nbworkers' alone, or 1, 2, 4, ... up to (and including) 'sweep'
+    **/
+    ::std::vector<size_t> get_thread_counts(size_t nbcpus) const {
+        if (!oversubscribe.empty()) {
+            ::std::vector<size_t> res;
+            for (auto factor: oversubscribe)
+                res.push_back(factor * (nbcpus > 0 ? nbcpus : default_nbworkers()));
+            return res;
+        }
+        if (sweep == 0)
+            return {nbworkers};
+        return get_powers(sweep);
+    }
+    /** Print the usage.
+     * @param argv0 Name of the program
+    **/
+    static void usage(char const* argv0) {
+        ::std::cout << "Usage: " << argv0 << " [options] <seed> <reference library path> <tested library path>..." << ::std::endl;
+        ::std::cout << "       " << argv0 << " [options] --seed <seed> <reference library path> <tested library path>..." << ::std::endl;
+        ::std::cout << "Options ('--key value' or '--key=value'):" << ::std::endl;
+        ::std::cout << "  --threads <n>            Number of worker threads (default: #hardware threads)" << ::std::endl;
+        ::std::cout << "  --tx <n>                 Total number of transactions, split among the workers (default: 200000)" << ::std::endl;
+        ::std::cout << "  --tx-per-worker <n>      Number of transactions per worker (overrides --tx)" << ::std::endl;
+        ::std::cout << "  --accounts <n>           Initial number of accounts per worker (default: 32)" << ::std::endl;
+        ::std::cout << "  --expected-accounts <n>  Expected number of accounts per worker (default: 256)" << ::std::endl;
+        ::std::cout << "  --balance <n>            Initial account balance (default: 100)" << ::std::endl;
+        ::std::cout << "  --prob-long <p>          Probability of a long read-only transaction (default: 0.5)" << ::std::endl;
+        ::std::cout << "  --prob-alloc <p>         Probability of an allocation transaction, otherwise (default: 0.01)" << ::std::endl;
+        ::std::cout << "  --repeats <n>            Number of repetitions, the median is kept (default: 7)" << ::std::endl;
+        ::std::cout << "  --warmup <n>             Number of discarded repetitions before the measured ones (default: 0)" << ::std::endl;
+        ::std::cout << "  --seed <n>               Seed for the performance measurements" << ::std::endl;
+        ::std::cout << "  --slow-factor <n>        Timeout, as a multiple of the reference's time (default: 16)" << ::std::endl;
+        ::std::cout << "  --skew <kind>            Bank account choice: uniform, zipf or hotset (default: uniform)" << ::std::endl;
+        ::std::cout << "  --zipf-theta <t>         Zipf exponent, in [0, 1) (default: 0.99)" << ::std::endl;
+        ::std::cout << "  --hot-fraction <f>       Fraction of the accounts in the hot set (default: 0.1)" << ::std::endl;
+        ::std::cout << "  --hot-prob <p>           Probability of choosing a hot account (default: 0.9)" << ::std::endl;
+        ::std::cout << "  --scan <on|off>          Read each segment of accounts of the bank long transactions at once (default: off)" << ::std::endl;
+        ::std::cout << "  --workload <name>        Workload: bank, list, hashmap, rbtree, vacation, kmeans, region or txsize (default: bank)" << ::std::endl;
+        ::std::cout << "  --keys <n>               Number of keys/resources of list, hashmap, rbtree and vacation (default: 1024)" << ::std::endl;
+        ::std::cout << "  --prob-update <p>        Probability of an updating transaction, same workloads and region (default: 0.2)" << ::std::endl;
+        ::std::cout << "  --region-mb <n,...>      Shared memory region sizes of region and txsize, each evaluated in turn (default: 256)" << ::std::endl;
+        ::std::cout << "  --tx-reads <n>           Evaluate txsize with 1, 2, 4, ... up to <n> words read per transaction (default: 64)" << ::std::endl;
+        ::std::cout << "  --tx-writes <n>          Evaluate txsize with 0, 1, 2, 4, ... up to <n> words written per transaction (default: 16)" << ::std::endl;
+        ::std::cout << "  --duration <ms>          Run each repetition for a fixed time instead of a fixed #TX (default: 0, off)" << ::std::endl;
+        ::std::cout << "  --interval <ms>          Period of the throughput timeline of timed repetitions (default: 100)" << ::std::endl;
+        ::std::cout << "  --latency <on|off>       Record per-transaction latency percentiles, per transaction type (default: off)" << ::std::endl;
+        ::std::cout << "  --counters <on|off>      Report hardware performance counters per transaction, if the kernel allows (default: off)" << ::std::endl;
+        ::std::cout << "  --pin <policy>           Pin the workers: none, compact, scatter, nosmt or a CPU list like 0,2,4-7 (default: none)" << ::std::endl;
+        ::std::cout << "  --wait <spin|futex>      How idle harness threads wait: spin, or spin then sleep on a futex (default: spin)" << ::std::endl;
+        ::std::cout << "  --isolate <on|off>       Evaluate each library, thread count and shape in a forked process (default: off)" << ::std::endl;
+        ::std::cout << "  --isolate-timeout <s>    Kill an isolated evaluation after that many seconds (default: 600)" << ::std::endl;
+        ::std::cout << "  --baseline <path>        Compare the throughputs with a JSON report, exit with 3 on a significant slowdown" << ::std::endl;
+        ::std::cout << "  --confidence <p>         Confidence level of the bootstrap intervals of --baseline (default: 0.95)" << ::std::endl;
+        ::std::cout << "  --tolerance <p>          Relative slowdown tolerated by --baseline (default: 0)" << ::std::endl;
+        ::std::cout << "  --memory <on|off>        Count the heap allocations and the peak RSS, at a small cost on each malloc and free (default: off)" << ::std::endl;
+        ::std::cout << "  --mem-tolerance <r>      Relative growth of heap bytes/TX and peak RSS tolerated by --baseline (default: 0.1)" << ::std::endl;
+        ::std::cout << "  --sweep <n>              Evaluate 1, 2, 4, ... up to <n> threads, instead of --threads" << ::std::endl;
+        ::std::cout << "  --oversubscribe <f,...>  Evaluate 1x and the given multiples (e.g. 2,4) of the available CPUs as threads, with latencies" << ::std::endl;
+        ::std::cout << "  --format <csv|json>      Format of the machine-readable report (default: none, or from --output)" << ::std::endl;
+        ::std::cout << "  --output <path>          Path of the machine-readable report, '-' for stdout (default: -)" << ::std::endl;
+        ::std::cout << "  --config <path>          Read 'key = value' lines from a file, keys as above without '--'" << ::std::endl;
+        ::std::cout << "  --help, -h               Print this usage and exit" << ::std::endl;
+    }
+};
@@ -24,13 +24,28 @@
 // External headers
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <sstream>
 #include <random>
 #include <variant>
+#include <vector>
 
 // Internal headers
+#include "affinity.hpp"
 #include "common.hpp"
+#include "compare.hpp"
+#include "config.hpp"
+#include "isolation.hpp"
+#include "memory.hpp"
+#include "perf.hpp"
+#include "region.hpp"
+#include "report.hpp"
+#include "stamp.hpp"
 #include "transactional.hpp"
 #include "workload.hpp"
 
@@ -71,12 +86,15 @@ public:
     **/
     void master_notify() noexcept {
         status.store(Status::Wait, ::std::memory_order_relaxed);
+        runtime.reset(); // Each 'master_wait' reports its own segment, not the total since the first one
         runtime.start();
+        Waiting::wake(status);
     }
     /** Master trigger termination in all threads (instead of notifying).
     **/
     void master_join() noexcept {
         status.store(Status::Quit, ::std::memory_order_relaxed);
+        Waiting::wake(status);
     }
     /** Master wait for all workers to finish.
      * @param maxtick Maximum number of ticks to wait before exiting the process on an error (optional, 'invalid_tick' for none)
@@ -96,7 +114,7 @@ public:
             throw Exception::Unreachable{"Master woke after raised latch, no timeout, but unexpected status"};
         }
     }
-    /** Worker spin-wait until next run.
+    /** Worker wait until next run.
      * @return Whether the worker can proceed, or quit otherwise
     **/
     bool worker_wait() noexcept {
@@ -106,18 +124,19 @@ public:
                 break;
             if (res == Status::Quit)
                 return false;
-            short_pause();
+            Waiting::wait(status, res);
         }
         auto res = nbready.fetch_add(1, ::std::memory_order_relaxed);
         if (res + 1 == nbworkers) { // Latest worker, switch to run status
             nbready.store(0, ::std::memory_order_relaxed);
             status.store(Status::Run, ::std::memory_order_release); // Synchronize-with previous worker waiting for run/abort state
-        } else do { // Not latest worker, wait for run status
-            short_pause();
+            Waiting::wake(status);
+        } else while (true) { // Not latest worker, wait for run status
             auto res = status.load(::std::memory_order_acquire); // Synchronize-with latest worker switching to run/abort state
             if (res == Status::Run || res == Status::Abort)
                 break;
-        } while (true);
+            Waiting::wait(status, res);
+        }
         return true;
     }
     /** Worker notify termination of its run.
@@ -138,20 +157,63 @@ public:
     }
 };
 
-/** Measure the arithmetic mean of the execution time of the given workload with the given transaction library.
- * @param workload     Workload instance to use
- * @param nbthreads    Number of concurrent threads to use
- * @param nbrepeats    Number of repetitions (keep the median)
- * @param seed         Seed to use for performance measurements
- * @param maxtick_init Timeout for (re)initialization ('Chrono::invalid_tick' for none)
- * @param maxtick_perf Timeout for performance measurements ('Chrono::invalid_tick' for none)
- * @param maxtick_chck Timeout for correctness check ('Chrono::invalid_tick' for none)
- * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected)
+/** Transaction counts of one time-bounded repetition.
+**/
+struct TimedRun {
+    ::std::vector<uint_fast64_t> per_worker; // Transactions of each worker
+    ::std::vector<uint_fast64_t> timeline;   // Transactions of all the workers at the end of each interval (cumulative)
+};
+
+/** Parameters of a measurement.
 **/
-static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck) {
+struct MeasureSetup {
+    unsigned int nbthreads;    // Number of concurrent threads to use
+    unsigned int nbrepeats;    // Number of repetitions (keep the median)
+    unsigned int nbwarmups;    // Number of discarded repetitions, before the measured ones
+    Seed         seed;         // Seed to use for performance measurements
+    Chrono::Tick maxtick_init; // Timeout for (re)initialization ('Chrono::invalid_tick' for none)
+    Chrono::Tick maxtick_perf; // Timeout for performance measurements ('Chrono::invalid_tick' for none)
+    Chrono::Tick maxtick_chck; // Timeout for correctness check ('Chrono::invalid_tick' for none)
+    Chrono::Tick duration;     // Duration of each performance measurement (in ns), 0 to run a fixed number of transactions instead
+    Chrono::Tick interval;     // Period at which the transactions are counted during a time-bounded performance measurement (in ns)
+    bool         latency;      // Whether to record the latency of every transaction during the performance measurements
+    bool         counters;     // Whether to read the hardware performance counters of every worker during the performance measurements
+    ::std::vector<unsigned int> cpus; // CPU to pin each worker to, empty for no pinning
+};
+
+/** Results of a measurement.
+**/
+struct Measurement {
+    char const*   error = nullptr;                  // Error constant null-terminated string ('nullptr' for none), the other results are undefined if set
+    Chrono::Tick  time_init = Chrono::invalid_tick; // Execution time of the initialization (in ns)
+    ::std::vector<Chrono::Tick> times;              // Execution time of every measured performance repetition (in ns)
+    Chrono::Tick  time_chck = Chrono::invalid_tick; // Execution time of the correctness check (in ns)
+    ::std::vector<TimedRun> runs;                   // Transaction counts of every time-bounded repetition
+    ::std::vector<TxStats>  stats;                  // Attempt/commit/retry statistics (and latencies, if recorded) of every transaction type over all the repetitions
+    PerfCounters::Totals hardware;                  // Hardware performance counters summed over all the workers and repetitions (all unavailable if not read)
+    Allocations   heap;                             // Heap allocations of the process during the measured repetitions
+    uint_fast64_t preemptions = 0;                  // Number of times the workers were preempted during the measured repetitions
+};
+
+/** Measure the execution time of the given workload with the given transaction library, over several repetitions.
+ * @param workload Workload instance to use
+ * @param setup    Parameters of the measurement
+ * @return Results of the measurement
+**/
+static Measurement measure(Workload& workload, MeasureSetup const& setup) {
+    auto const nbthreads = setup.nbthreads;
+    auto const nbrepeats = setup.nbrepeats;
+    auto const nbwarmups = setup.nbwarmups;
     ::std::vector<::std::thread> threads(nbthreads);
     ::std::mutex  cerrlock;        // To avoid interleaving writes to 'cerr' in case more than one thread throw
     Sync          sync{nbthreads}; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
+    Deadline  deadline{nbthreads}; // Stops the workers and counts their transactions, when time-bounded
+    if (setup.duration > 0)
+        workload.set_deadline(&deadline);
+    auto const nbtypes = workload.get_tx_types().size();
+    ::std::vector<TxRecorder> recorders(nbthreads, TxRecorder{nbtypes, setup.latency}); // One per worker, not to share cache lines while recording
+    ::std::vector<PerfCounters> perfs(setup.counters ? nbthreads : 0); // One per worker, opened by the worker itself
+    ::std::vector<uint_fast64_t> preempted(nbthreads, 0); // Involuntary context switches of each worker
     
     // We start nbthreads threads to measure performance.
     for (unsigned int i = 0; i < nbthreads; ++i) { // Start threads
@@ -161,14 +223,29 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
                 // It is devided into a series of small tests. Each test is specified in workload.hpp.
                 // Threads are synchronized between each test so that they run with a lot of concurrency.
                 try {
+                    if (setup.counters)
+                        perfs[i].open();
                     // 1. Initialization
                     if (!sync.worker_wait()) return; // Sync. of threads
                     sync.worker_notify(workload.init()); // Runs the test and tells the master about errors
 
                     // 2. Performance measurements
-                    for (unsigned int count = 0; count < nbrepeats; ++count) {
+                    for (unsigned int count = 0; count < nbwarmups + nbrepeats; ++count) {
                         if (!sync.worker_wait()) return;
-                        sync.worker_notify(workload.run(i, seed + nbthreads * count + i));
+                        auto const warmup = count < nbwarmups;
+                        auto const index = warmup ? nbrepeats + count : count - nbwarmups; // Measured repetitions keep their seeds
+                        if (!warmup)
+                            TxRecorder::install(&recorders[i]);
+                        if (setup.counters && !warmup)
+                            perfs[i].start();
+                        auto const switches = Preemptions::get();
+                        auto error = workload.run(i, setup.seed + nbthreads * index + i);
+                        if (!warmup)
+                            preempted[i] += Preemptions::get() - switches;
+                        if (setup.counters && !warmup)
+                            perfs[i].stop();
+                        TxRecorder::install(nullptr);
+                        sync.worker_notify(error);
                     }
 
                     // 3. Correctness check
@@ -199,47 +276,77 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
     // After all tests succeed, it returns the time it took to run each test.
     // It returns early in case of a failure.
     try {
-        char const* error = nullptr;
-        Chrono::Tick time_init = Chrono::invalid_tick;
-        Chrono::Tick times[nbrepeats];
-        Chrono::Tick time_chck = Chrono::invalid_tick;
-        auto const posmedian = nbrepeats / 2;
+        Measurement results;
+        results.times.resize(nbrepeats);
+        for (unsigned int i = 0; i < setup.cpus.size() && i < nbthreads; ++i) // Pin the workers while they wait for the first step
+            Placement::pin(threads[i], setup.cpus[i]);
         { // Initialization (with cheap correctness test)
             sync.master_notify(); // We tell workers to start working.
-            auto res = sync.master_wait(maxtick_init); // If running the student's version, it will timeout if way slower than the reference.
+            auto res = sync.master_wait(setup.maxtick_init); // If running the student's version, it will timeout if way slower than the reference.
             if (unlikely(::std::holds_alternative<char const*>(res))) { // If an error happened (timeout or violation), we return early!
-                error = ::std::get<char const*>(res);
+                results.error = ::std::get<char const*>(res);
                 goto join;
             }
-            time_init = ::std::get<Chrono>(res).get_tick();
+            results.time_init = ::std::get<Chrono>(res).get_tick();
         }
         { // Performance measurements (with cheap correctness tests)
-            for (unsigned int i = 0; i < nbrepeats; ++i) {
+            for (unsigned int count = 0; count < nbwarmups + nbrepeats; ++count) {
+                TimedRun run;
+                if (setup.duration > 0) // Not to count the master's allocations
+                    run.timeline.reserve(static_cast<size_t>((setup.duration + setup.interval - 1) / setup.interval));
+                deadline.reset();
+                auto before = Allocations::snapshot();
                 sync.master_notify();
-                auto res = sync.master_wait(maxtick_perf);
+                if (setup.duration > 0) { // Count the transactions at every interval, then stop the workers
+                    auto start = ::std::chrono::steady_clock::now();
+                    for (Chrono::Tick elapsed = 0; elapsed < setup.duration;) {
+                        elapsed = ::std::min(elapsed + setup.interval, setup.duration);
+                        ::std::this_thread::sleep_until(start + ::std::chrono::nanoseconds{elapsed});
+                        run.timeline.push_back(deadline.get_total());
+                    }
+                    deadline.expire();
+                }
+                auto res = sync.master_wait(setup.maxtick_perf);
                 if (unlikely(::std::holds_alternative<char const*>(res))) {
-                    error = ::std::get<char const*>(res);
+                    results.error = ::std::get<char const*>(res);
                     goto join;
                 }
-                times[i] = ::std::get<Chrono>(res).get_tick();
+                if (count < nbwarmups) // Discarded
+                    continue;
+                results.heap.merge(Allocations::snapshot() - before); // Complete, the master synchronized with every worker
+                results.times[count - nbwarmups] = ::std::get<Chrono>(res).get_tick();
+                if (setup.duration > 0) {
+                    for (unsigned int j = 0; j < nbthreads; ++j)
+                        run.per_worker.push_back(deadline.get(j));
+                    results.runs.push_back(::std::move(run));
+                }
             }
-            ::std::nth_element(times, times + posmedian, times + nbrepeats); // Partition times around the median
         }
         { // Correctness check
             sync.master_notify();
-            auto res = sync.master_wait(maxtick_chck);
+            auto res = sync.master_wait(setup.maxtick_chck);
             if (unlikely(::std::holds_alternative<char const*>(res))) {
-                error = ::std::get<char const*>(res);
+                results.error = ::std::get<char const*>(res);
                 goto join;
             }
-            time_chck = ::std::get<Chrono>(res).get_tick();
+            results.time_chck = ::std::get<Chrono>(res).get_tick();
         }
         join: { // Joining
             sync.master_join(); // Join with threads
             for (unsigned int i = 0; i < nbthreads; ++i)
                 threads[i].join();
         }
-        return ::std::make_tuple(error, time_init, times[posmedian], time_chck);
+        workload.set_deadline(nullptr);
+        results.stats.resize(nbtypes);
+        for (auto&& recorder: recorders) {
+            for (size_t t = 0; t < nbtypes; ++t)
+                results.stats[t].merge(recorder.get_stats()[t]);
+        }
+        results.hardware = PerfCounters::Totals{setup.counters};
+        for (auto&& perf: perfs)
+            results.hardware.merge(perf.get_totals());
+        results.preemptions = ::std::accumulate(preempted.begin(), preempted.end(), uint_fast64_t{0});
+        return results;
     } catch (...) {
         for (unsigned int i = 0; i < nbthreads; ++i) // Detach threads to avoid termination due to attached thread going out of scope
             threads[i].detach();
@@ -247,47 +354,873 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
     }
 }
 
+/** Jain's fairness index of the per-worker transaction counts.
+ * @param counts Transaction count of each worker
+ * @return Fairness index, from 1/n (one worker did everything) to 1 (all did the same)
+**/
+static double fairness(::std::vector<uint_fast64_t> const& counts) {
+    double sum = 0.;
+    double sumsq = 0.;
+    for (auto count: counts) {
+        auto value = static_cast<double>(count);
+        sum += value;
+        sumsq += value * value;
+    }
+    if (sumsq == 0.)
+        return 1.;
+    return sum * sum / (static_cast<double>(counts.size()) * sumsq);
+}
+
 // -------------------------------------------------------------------------- //
 
-/** Program entry point.
- * @param argc Arguments count
- * @param argv Arguments values
- * @return Program return code
+/** Build the selected workload.
+ * @param config     Run parameters
+ * @param library    Transactional library to use
+ * @param nbworkers  Number of worker threads
+ * @param nbtxperwrk Number of transactions per worker
+ * @return Workload instance (shared memory lifetime bound to workload: created and destroyed at the same time)
 **/
-int main(int argc, char** argv) {
-    try {
-        // Parse command line option(s)
-        if (argc < 3) {
-            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " <seed> <reference library path> <tested library path>..." << ::std::endl;
-            return 1;
+static ::std::unique_ptr<Workload> make_workload(Config const& config, TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, Config::Shape const& shape) {
+    if (config.workload == "list")
+        return ::std::make_unique<WorkloadList>(library, nbworkers, nbtxperwrk, config.nbkeys, config.prob_update);
+    if (config.workload == "hashmap")
+        return ::std::make_unique<WorkloadHashMap>(library, nbworkers, nbtxperwrk, config.nbkeys, config.prob_update);
+    if (config.workload == "rbtree")
+        return ::std::make_unique<WorkloadTree>(library, nbworkers, nbtxperwrk, config.nbkeys, config.prob_update);
+    if (config.workload == "vacation")
+        return ::std::make_unique<WorkloadVacation>(library, nbworkers, nbtxperwrk, config.nbkeys, config.prob_update);
+    if (config.workload == "kmeans")
+        return ::std::make_unique<WorkloadKmeans>(library, nbworkers, nbtxperwrk);
+    if (config.workload == "region")
+        return ::std::make_unique<WorkloadRegion>(library, nbworkers, nbtxperwrk, shape.region << 20, config.prob_update);
+    if (config.workload == "txsize")
+        return ::std::make_unique<WorkloadTxSize>(library, nbworkers, nbtxperwrk, shape.region << 20, shape.reads, shape.writes);
+    auto const init_balance = static_cast<WorkloadBank::Balance>(config.init_balance);
+    return ::std::make_unique<WorkloadBank>(library, nbworkers, nbtxperwrk, config.nbaccounts * nbworkers, config.expnbaccounts * nbworkers, init_balance, config.prob_long, config.prob_alloc, config.get_skew(), config.scan);
+}
+
+/** Evaluation of the libraries, measurement by measurement, each in this process or in an isolated child.
+**/
+class Evaluation final {
+private:
+    /** Results of one measurement and the statistics derived from them, shared by the printing and the recording.
+    **/
+    struct Point {
+        size_t c;            // Thread count index
+        size_t s;            // Shape index
+        size_t nbworkers;    // Number of worker threads
+        size_t nbtxperwrk;   // Number of transactions per worker
+        double pertxdiv;     // Number of transactions of a repetition, over all the workers
+        bool   last;         // Whether this is the last line of the library's block
+        bool   is_reference; // Whether the library is the reference
+        bool   compared;     // Whether there is a reference measurement to compare with
+        ::std::vector<unsigned int> cpus; // CPU of each worker, empty for no pinning
+        ::std::string cpulist;            // Applied placement, for the outputs
+        double overhead;     // Retained heap bytes of a region's metadata beyond its first segment, NaN if not counted
+        bool   peak_reset;   // Whether the peak RSS was reset before the measurement
+        uint_fast64_t peak;  // Peak RSS (in bytes), 0 if not measured
+        Measurement   res;   // Raw results of the measurement
+        bool     counted;         // Whether the library exports its counters
+        bool     false_counted;   // Whether it counts the false conflicts too
+        uint64_t false_conflicts; // Library-side false conflicts during the measurement
+        uint64_t library_aborts;  // Library-side aborts during the measurement
+        double   false_rate;      // Ratio of the two, NaN without aborts
+        ::std::vector<char const*> tx_types; // Name of every transaction type
+        ::std::vector<double> throughputs;   // Throughput of every repetition (sorted)
+        ::std::vector<double> fairnesses;    // Jain's index of every time-bounded repetition
+        size_t typical;                      // Repetition with the median throughput
+        ::std::vector<double> timeline;      // Throughput in each interval of the typical repetition
+        Summary runtime;     // Execution time over the repetitions
+        Summary throughput;  // Throughput over the repetitions
+        Summary commit;      // Committed transactions over the repetitions
+        Summary speedup;     // Throughput over the reference's, NaN if not compared
+        TxStats total;       // Over all the transaction types
+        double  alloc_bytes; // Heap bytes allocated per committed transaction, NaN if not counted
+        double  peak_bytes;  // Peak RSS (in bytes), NaN if not measured
+        ::std::optional<Comparison> versus;  // Against the baseline, if any
+        double growth[2] = {::std::nan(""), ::std::nan("")}; // Heap bytes per TX and peak RSS over the baseline's, NaN if not comparable
+        bool   bloated = false;              // Whether any of them grew more than tolerated
+        ::std::string differs;               // Setting of the baseline's run of this measurement that differs from ours, if any
+    };
+private:
+    static constexpr size_t nbresamples = 10000; // Bootstrap resamples per comparison
+    Config const&   config;
+    Topology const& topology;
+    ::std::vector<size_t> const thread_counts;
+    bool const oversubscribed;
+    ::std::vector<Config::Shape> const shapes; // Evaluated at each thread count
+    size_t const nbshapes;
+    bool const sized;    // Whether the shapes have a region size
+    bool const grid;     // Whether to sum up the throughputs and abort rates by reads and writes
+    bool const compact;  // One line per thread count (and shape)
+    bool const latency;  // Tail latencies show the preempted transactions
+    Seed const seed;
+    Chrono::Tick const duration;
+    Chrono::Tick const interval;
+    bool const timed;
+    size_t const nbpoints; // Measurements per library
+    ::std::optional<Report> baseline; // Results to compare against, if any
+    Report report;
+    ::std::vector<double> reference; // Reference median throughput, per thread count (and shape)
+    ::std::vector<Chrono::Tick> maxtick_init;
+    ::std::vector<Chrono::Tick> maxtick_perf;
+    ::std::vector<Chrono::Tick> maxtick_chck;
+    ::std::vector<bool> no_reference; // Whether the reference evaluation of a measurement failed, leaving no speedup and no timeouts
+    bool slowdown;   // Whether any measurement is significantly slower than its baseline
+    bool regression; // Whether any measurement uses significantly more memory than its baseline
+    int  failed;     // Exit code of the worst failed isolated evaluation: 1 for a violation, 2 otherwise, 0 for none
+    ::std::vector<double> single;           // Median throughput with a single thread, per shape, for the scaling factor (current library)
+    ::std::vector<double> grid_throughputs; // Median throughput and abort rate of each measurement, for the grid (current library)
+    ::std::vector<double> grid_aborts;
+private:
+    /** Speedup against the reference, for the libraries other than the reference.
+     * @param point Measurement
+     * @return Text to print
+    **/
+    static ::std::string speedup_text(Point const& point) {
+        ::std::ostringstream text;
+        if (point.compared) {
+            text << point.speedup.median << " speedup";
+        } else {
+            text << "no reference";
+        }
+        return text.str();
+    }
+    /** Relative change against the baseline, with its interval and verdict.
+     * @param point Measurement
+     * @return Text to print
+    **/
+    ::std::string versus_text(Point const& point) const {
+        ::std::ostringstream text;
+        auto percent = [](double ratio) { return (ratio - 1.) * 100.; };
+        auto& versus = point.versus;
+        if (!versus) {
+            text << (point.differs.empty() ? "no matching baseline" : "not comparable, the baseline has another '" + point.differs + "'");
+            return text.str();
+        }
+        text << ::std::showpos << percent(versus->ratio) << " % [" << percent(versus->low) << " %, " << percent(versus->high) << " %]" << ::std::noshowpos << " at " << (config.confidence * 100.) << " % confidence";
+        if (versus->is_slowdown(config.tolerance)) {
+            text << " -> significant slowdown";
+        } else if (versus->low > 1.) {
+            text << " -> significant speedup";
+        } else {
+            text << " -> no significant slowdown";
+        }
+        return text.str();
+    }
+    /** Heap and peak RSS growth against the baseline, with the verdict.
+     * @param point Measurement
+     * @return Text to print
+    **/
+    static ::std::string memory_text(Point const& point) {
+        ::std::ostringstream text;
+        auto percent = [](double ratio) { return (ratio - 1.) * 100.; };
+        auto& growth = point.growth;
+        if (::std::isnan(growth[0]) && ::std::isnan(growth[1])) {
+            text << (point.differs.empty() ? "no matching baseline" : "not comparable, the baseline has another '" + point.differs + "'");
+            return text.str();
+        }
+        text << ::std::showpos;
+        if (!::std::isnan(growth[0]))
+            text << percent(growth[0]) << " % bytes/TX" << (::std::isnan(growth[1]) ? "" : ", ");
+        if (!::std::isnan(growth[1]))
+            text << percent(growth[1]) << " % peak RSS";
+        text << ::std::noshowpos << (point.bloated ? " -> memory regression" : " -> within tolerance");
+        return text.str();
+    }
+    /** Heap value per committed transaction.
+     * @param point Measurement
+     * @param value Heap value over the measurement
+     * @return Value per transaction, NaN if not counted
+    **/
+    static double per_commit(Point const& point, double value) {
+        if (!Allocations::is_hooked() || point.total.commits == 0)
+            return ::std::nan("");
+        return value / static_cast<double>(point.total.commits);
+    }
+    /** Hardware event count per committed transaction.
+     * @param point Measurement
+     * @param event Event to get
+     * @return Count per transaction, NaN if unavailable
+    **/
+    static double per_tx(Point const& point, PerfCounters::Event event) {
+        auto& hardware = point.res.hardware;
+        if (!hardware.available[event] || point.total.commits == 0)
+            return ::std::nan("");
+        return hardware.values[event] / static_cast<double>(point.total.commits);
+    }
+private:
+    /** Compute the statistics of a measurement over its repetitions, and set the reference performance if needed.
+     * @param point Measurement, with its raw results
+     * @param p     Measurement index
+    **/
+    void summarize(Point& point, size_t p) {
+        auto& res = point.res;
+        auto& runs = res.runs;
+        ::std::vector<double> commits;
+        for (size_t r = 0; r < res.times.size(); ++r) {
+            if (timed) { // Transactions committed before the deadline, over the duration
+                commits.push_back(static_cast<double>(runs[r].timeline.back()));
+                point.throughputs.push_back(commits[r] * 1000000000. / static_cast<double>(duration));
+            } else {
+                commits.push_back(point.pertxdiv);
+                point.throughputs.push_back(point.pertxdiv * 1000000000. / static_cast<double>(res.times[r]));
+            }
+            if (timed)
+                point.fairnesses.push_back(fairness(runs[r].per_worker));
+        }
+        point.typical = 0;
+        if (timed) {
+            auto& throughputs = point.throughputs;
+            ::std::vector<size_t> order(throughputs.size());
+            ::std::iota(order.begin(), order.end(), 0);
+            ::std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return throughputs[a] < throughputs[b]; });
+            point.typical = order[order.size() / 2];
+        }
+        for (size_t t = 0; timed && t < runs[point.typical].timeline.size(); ++t) {
+            auto& counts = runs[point.typical].timeline;
+            auto before = t > 0 ? counts[t - 1] : 0;
+            auto length = ::std::min(interval, duration - static_cast<Chrono::Tick>(t) * interval);
+            point.timeline.push_back(static_cast<double>(counts[t] - before) * 1000000000. / static_cast<double>(length));
+        }
+        point.runtime = Summary{res.times};
+        point.throughput = Summary{point.throughputs};
+        point.commit = Summary{commits};
+        if (point.is_reference) { // Set reference performance
+            auto timeout = [&](Chrono::Tick tick) { // At least a second, so that short phases do not time out on scheduling noise
+                auto res = ::std::max<Chrono::Tick>(config.slow_factor * tick, 1000000000);
+                if (unlikely(res == Chrono::invalid_tick)) // Bad luck...
+                    ++res;
+                return res;
+            };
+            maxtick_init[p] = timeout(res.time_init);
+            maxtick_perf[p] = timeout(static_cast<Chrono::Tick>(point.runtime.median));
+            maxtick_chck[p] = timeout(res.time_chck);
+            reference[p] = point.throughput.median;
+        }
+        point.compared = !point.is_reference && !no_reference[p];
+        ::std::vector<double> speedups;
+        for (auto value: point.throughputs)
+            speedups.push_back(point.compared ? value / reference[p] : ::std::nan(""));
+        point.speedup = Summary{speedups};
+        if (point.nbworkers == 1 || (oversubscribed && point.c == 0))
+            single[point.s] = point.throughput.median;
+        for (auto&& entry: res.stats)
+            point.total.merge(entry);
+        point.alloc_bytes = per_commit(point, static_cast<double>(res.heap.bytes));
+        point.peak_bytes = point.peak > 0 ? static_cast<double>(point.peak) : ::std::nan("");
+    }
+    /** Build the record of a measurement, with the fields that identify it and the configuration it ran with.
+     * @param point    Measurement
+     * @param path     Path of the library
+     * @param workload Measured workload
+     * @param shape    Shape of the measurement
+     * @return Record, identified first to find the matching baseline
+    **/
+    Record identify(Point const& point, ::std::string const& path, Workload const& workload, Config::Shape const& shape) const {
+        Record record;
+        record.set("library", path);
+        record.set("workload", config.workload);
+        if (config.workload == "bank") {
+            static char const* const skews[] = {"uniform", "zipf", "hotset"};
+            record.set("skew", skews[static_cast<int>(config.skew)]);
+            record.set("scan", config.scan ? "on" : "off");
+            record.set("accounts", static_cast<double>(config.nbaccounts));
+            record.set("expected_accounts", static_cast<double>(config.expnbaccounts));
+            record.set("init_balance", static_cast<double>(config.init_balance));
+            record.set("prob_long", static_cast<double>(config.prob_long));
+            record.set("prob_alloc", static_cast<double>(config.prob_alloc));
+            if (config.skew == Skew::Kind::zipf)
+                record.set("zipf_theta", config.zipf_theta);
+            if (config.skew == Skew::Kind::hotset) {
+                record.set("hot_fraction", config.hot_fraction);
+                record.set("hot_prob", config.hot_prob);
+            }
+        } else if (config.workload != "kmeans" && config.workload != "txsize") {
+            if (config.workload != "region")
+                record.set("keys", static_cast<double>(config.nbkeys));
+            record.set("prob_update", static_cast<double>(config.prob_update));
+        }
+        if (sized)
+            record.set("region_bytes", static_cast<double>(workload.get_tm().get_size()));
+        if (grid) {
+            record.set("tx_reads", static_cast<double>(shape.reads));
+            record.set("tx_writes", static_cast<double>(shape.writes));
+        }
+        record.set("reference", point.is_reference ? 1. : 0.);
+        record.set("placement", config.placement.get_name());
+        record.set("waiting", Waiting::get_name());
+        if (!point.cpus.empty())
+            record.set("cpus", point.cpulist);
+        record.set("threads", static_cast<double>(point.nbworkers));
+        if (timed) {
+            record.set("duration_ms", static_cast<double>(config.duration));
+        } else {
+            record.set("tx_per_worker", static_cast<double>(point.nbtxperwrk));
+        }
+        return record;
+    }
+    /** Compare a measurement with its run in the baseline, if any.
+     * @param point  Measurement
+     * @param record Identified record of the measurement
+    **/
+    void compare(Point& point, Record const& record) {
+        if (!baseline)
+            return;
+        auto match = find_baseline(*baseline, record, point.differs);
+        char const* const keys[2] = {"alloc_bytes_per_tx", "peak_rss_bytes"};
+        double const values[2] = {point.alloc_bytes, point.peak_bytes};
+        for (size_t m = 0; match && m < 2; ++m) {
+            auto old = match->get(keys[m]);
+            if (!old || !::std::holds_alternative<double>(*old) || !(::std::get<double>(*old) > 0.) || ::std::isnan(values[m]))
+                continue;
+            point.growth[m] = values[m] / ::std::get<double>(*old);
+            if (point.growth[m] > 1. + config.mem_tolerance)
+                point.bloated = true;
+        }
+        if (point.bloated)
+            regression = true;
+        auto samples = parse_samples(match ? match->get("throughput_samples") : nullptr);
+        if (!samples.empty()) {
+            point.versus.emplace(::std::move(samples), point.throughputs, config.confidence, nbresamples, seed);
+            if (point.versus->is_slowdown(config.tolerance))
+                slowdown = true;
+        }
+    }
+    /** Print the results of a measurement, as a block of lines.
+     * @param point Measurement
+    **/
+    void print_detailed(Point const& point) const {
+        auto const perfdbl = point.runtime.median;
+        auto& stats = point.res.stats;
+        auto& hardware = point.res.hardware;
+        auto& heap = point.res.heap;
+        if (timed) {
+            ::std::cout << "⎪ Committed TX:              " << point.commit.median << " in " << config.duration << " ms (run took " << (perfdbl / 1000000.) << " ms)" << ::std::endl;
+        } else {
+            ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
+            if (!point.is_reference) // Compare with reference performance
+                ::std::cout << " -> " << speedup_text(point);
+            ::std::cout << ::std::endl;
+        }
+        ::std::cout << "⎪ Throughput:                " << point.throughput.median << " TX/s";
+        if (timed && !point.is_reference)
+            ::std::cout << " -> " << speedup_text(point);
+        ::std::cout << ::std::endl;
+        if (baseline)
+            ::std::cout << "⎪ Against the baseline:      " << versus_text(point) << ::std::endl;
+        if (!point.cpus.empty())
+            ::std::cout << "⎪ Worker CPUs:               " << point.cpulist << ::std::endl;
+        if (config.memory) {
+            ::std::cout << "⎪ Memory:                    peak RSS ";
+            if (point.peak > 0) {
+                ::std::cout << (point.peak_bytes / 1048576.) << " MiB" << (point.peak_reset ? "" : " (since start)");
+            } else {
+                ::std::cout << "n/a";
+            }
+            if (Allocations::is_hooked()) {
+                ::std::cout << ", " << point.alloc_bytes << " B in " << per_commit(point, static_cast<double>(heap.count)) << " allocation(s) per TX (" << per_commit(point, heap.get_retained()) << " B retained)";
+                ::std::cout << ", region metadata " << point.overhead << " B";
+            }
+            ::std::cout << ::std::endl;
+            if (baseline)
+                ::std::cout << "⎪ Memory vs the baseline:    " << memory_text(point) << ::std::endl;
+        }
+        ::std::cout << "⎪ False conflicts:           ";
+        if (point.false_counted) {
+            ::std::cout << "~" << point.false_conflicts << " of the library's " << point.library_aborts << " abort(s) on a lock last taken for another address";
+            if (point.library_aborts > 0)
+                ::std::cout << " (" << (point.false_rate * 100.) << " %)";
+            ::std::cout << ", approximate" << ::std::endl;
+        } else if (point.counted) {
+            ::std::cout << "n/a (the library does not count them, 'make -C 394984 false-conflicts' builds ours with the count)" << ::std::endl;
+        } else {
+            ::std::cout << "n/a (the library does not export 'tm_stats')" << ::std::endl;
+        }
+        auto padded = [](::std::string label) { // Align the values with the other lines
+            return label + ::std::string(label.size() < 27 ? 27 - label.size() : 1, ' ');
+        };
+        for (size_t t = 0; t < stats.size(); ++t) {
+            auto& entry = stats[t];
+            if (entry.commits == 0)
+                continue;
+            auto& retries = entry.retries;
+            ::std::cout << "⎪ " << padded("Aborts (" + ::std::string{point.tx_types[t]} + "):") << (entry.get_abort_rate() * 100.) << " % of " << entry.attempts << " attempts, retries p50 " << retries.get_percentile(50.) << ", p99 " << retries.get_percentile(99.) << ", max " << retries.get_max() << ::std::endl;
+        }
+        for (size_t t = 0; t < stats.size(); ++t) {
+            auto& histogram = stats[t].latency;
+            if (histogram.get_count() == 0)
+                continue;
+            ::std::cout << "⎪ " << padded("Latency (" + ::std::string{point.tx_types[t]} + "):") << "p50 " << histogram.get_percentile(50.) << ", p90 " << histogram.get_percentile(90.) << ", p99 " << histogram.get_percentile(99.) << ", p99.9 " << histogram.get_percentile(99.9) << " ns (" << histogram.get_count() << " TX)" << ::std::endl;
+        }
+        if (config.counters) {
+            ::std::cout << "⎪ Counters per TX:           ";
+            if (hardware.any()) {
+                static char const* const labels[PerfCounters::nbevents] = {"cycles", "instructions", "LLC misses", "branch misses", "context switches"};
+                for (size_t e = 0; e < PerfCounters::nbevents; ++e) {
+                    auto value = per_tx(point, static_cast<PerfCounters::Event>(e));
+                    ::std::cout << (e > 0 ? ", " : "");
+                    if (::std::isnan(value)) {
+                        ::std::cout << "n/a";
+                    } else {
+                        ::std::cout << value;
+                    }
+                    ::std::cout << " " << labels[e];
+                }
+                if (hardware.available[PerfCounters::Cycles] && hardware.available[PerfCounters::Instructions] && hardware.values[PerfCounters::Cycles] > 0.)
+                    ::std::cout << " (IPC " << (hardware.values[PerfCounters::Instructions] / hardware.values[PerfCounters::Cycles]) << ")";
+                ::std::cout << ::std::endl;
+            } else {
+                ::std::cout << "unavailable (denied by the kernel, see /proc/sys/kernel/perf_event_paranoid)" << ::std::endl;
+            }
+        }
+        if (timed) {
+            auto& counts = point.res.runs[point.typical].per_worker;
+            ::std::cout << "⎪ Fairness (Jain's index):   " << fairness(counts) << " (per worker: " << *::std::min_element(counts.begin(), counts.end()) << " to " << *::std::max_element(counts.begin(), counts.end()) << " TX)" << ::std::endl;
+            ::std::cout << "⎩ Throughput over time:      ";
+            for (auto value: point.timeline)
+                ::std::cout << static_cast<uint_fast64_t>(value) << " ";
+            ::std::cout << "TX/s" << ::std::endl;
+        } else {
+            ::std::cout << "⎩ Average TX execution time: " << (perfdbl / point.pertxdiv) << " ns" << ::std::endl;
         }
-        // Get/set/compute run parameters
-        auto const nbworkers = []() {
-            auto res = ::std::thread::hardware_concurrency();
-            if (unlikely(res == 0))
-                res = 16;
-            return static_cast<size_t>(res);
-        }();
-        auto const nbtxperwrk    = 200000ul / nbworkers;
-        auto const nbaccounts    = 32 * nbworkers;
-        auto const expnbaccounts = 256 * nbworkers;
-        auto const init_balance  = 100ul;
-        auto const prob_long     = 0.5f;
-        auto const prob_alloc    = 0.01f;
-        auto const nbrepeats     = 7;
-        auto const seed          = static_cast<Seed>(::std::stoul(argv[1]));
-        auto const clk_res       = Chrono::get_resolution();
-        auto const slow_factor   = 16ul;
-        // Print run parameters
-        ::std::cout << "⎧ #worker threads:     " << nbworkers << ::std::endl;
-        ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
-        ::std::cout << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
-        ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
-        ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
-        ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
-        ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
-        ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
-        ::std::cout << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
+    }
+    /** Print the results of a measurement, as one line.
+     * @param point Measurement
+     * @param shape Shape of the measurement
+    **/
+    void print_compact(Point const& point, Config::Shape const& shape) const {
+        auto const alone = single[point.s];
+        ::std::cout << (point.last ? "⎩ " : "⎪ ");
+        if (config.workload == "region" || (grid && config.region_sizes.size() > 1))
+            ::std::cout << shape.region << " MiB, ";
+        if (grid)
+            ::std::cout << shape.reads << "R/" << shape.writes << "W, ";
+        if (oversubscribed) {
+            ::std::cout << config.oversubscribe[point.c] << "x (" << point.nbworkers << " thread(s)): ";
+        } else {
+            ::std::cout << point.nbworkers << " thread(s): ";
+        }
+        ::std::cout << (point.runtime.median / 1000000.) << " ms [" << (point.runtime.min / 1000000.) << ", " << (point.runtime.max / 1000000.) << "], " << point.throughput.median << " TX/s";
+        if (!point.is_reference)
+            ::std::cout << ", " << speedup_text(point);
+        if (alone > 0.)
+            ::std::cout << ", " << (point.throughput.median / alone) << (oversubscribed ? "x of 1x" : "x vs 1 thread");
+        if (timed)
+            ::std::cout << ", fairness " << fairness(point.res.runs[point.typical].per_worker);
+        ::std::cout << ", " << (point.total.get_abort_rate() * 100.) << " % aborts";
+        if (point.false_counted && point.library_aborts > 0)
+            ::std::cout << " (~" << (point.false_rate * 100.) << " % false conflicts)";
+        if (oversubscribed) {
+            ::std::cout << ", p99 " << point.total.latency.get_percentile(99.) << " ns, p99.9 " << point.total.latency.get_percentile(99.9) << " ns";
+            if (Preemptions::is_available())
+                ::std::cout << ", " << point.res.preemptions << " preemption(s)";
+        }
+        if (!point.cpus.empty())
+            ::std::cout << ", on CPUs " << point.cpulist;
+        if (point.peak > 0)
+            ::std::cout << ", peak RSS " << (point.peak_bytes / 1048576.) << " MiB";
+        if (Allocations::is_hooked())
+            ::std::cout << ", " << point.alloc_bytes << " heap B/TX";
+        if (baseline) {
+            ::std::cout << ", " << versus_text(point);
+            if (config.memory)
+                ::std::cout << ", memory " << memory_text(point);
+        }
+        ::std::cout << ::std::endl;
+    }
+    /** Add the results of a measurement to its record.
+     * @param point  Measurement
+     * @param record Identified record of the measurement
+    **/
+    void fill(Point& point, Record& record) const {
+        auto& res = point.res;
+        auto& stats = res.stats;
+        auto& total = point.total;
+        auto const alone = single[point.s];
+        record.set("repeats", static_cast<double>(config.nbrepeats));
+        record.set("runtime_ns", point.runtime);
+        record.set("throughput_txps", point.throughput);
+        {
+            ::std::ostringstream samples; // Every repetition, for later comparisons
+            samples.imbue(::std::locale::classic());
+            samples << ::std::setprecision(::std::numeric_limits<double>::max_digits10);
+            for (size_t r = 0; r < point.throughputs.size(); ++r)
+                samples << (r > 0 ? " " : "") << point.throughputs[r];
+            record.set("throughput_samples", samples.str());
+        }
+        if (point.versus) {
+            record.set("baseline_ratio", point.versus->ratio);
+            record.set("baseline_ratio_low", point.versus->low);
+            record.set("baseline_ratio_high", point.versus->high);
+            record.set("baseline_slowdown", point.versus->is_slowdown(config.tolerance) ? 1. : 0.);
+        }
+        record.set("speedup", point.speedup);
+        record.set("scaling", alone > 0. ? point.throughput.median / alone : ::std::nan(""));
+        record.set("attempts", static_cast<double>(total.attempts));
+        record.set("abort_rate", total.get_abort_rate());
+        for (size_t t = 0; t < stats.size(); ++t) {
+            auto prefix = "tx_" + ::std::string{point.tx_types[t]};
+            auto& entry = stats[t];
+            record.set(prefix + "_attempts", static_cast<double>(entry.attempts));
+            record.set(prefix + "_commits", static_cast<double>(entry.commits));
+            record.set(prefix + "_retries", static_cast<double>(entry.attempts - entry.commits));
+            record.set(prefix + "_retries_p50", static_cast<double>(entry.retries.get_percentile(50.)));
+            record.set(prefix + "_retries_p99", static_cast<double>(entry.retries.get_percentile(99.)));
+            record.set(prefix + "_retries_max", static_cast<double>(entry.retries.get_max()));
+        }
+        if (oversubscribed)
+            record.set("oversubscription", static_cast<double>(config.oversubscribe[point.c]));
+        if (Preemptions::is_available()) {
+            record.set("preemptions", static_cast<double>(res.preemptions));
+            record.set("preemptions_per_tx", total.commits > 0 ? static_cast<double>(res.preemptions) / static_cast<double>(total.commits) : ::std::nan(""));
+        }
+        if (latency) {
+            record.set("latency_p99_ns", static_cast<double>(total.latency.get_percentile(99.)));
+            record.set("latency_p999_ns", static_cast<double>(total.latency.get_percentile(99.9)));
+        }
+        for (size_t t = 0; latency && t < stats.size(); ++t) {
+            auto prefix = "latency_" + ::std::string{point.tx_types[t]};
+            auto& histogram = stats[t].latency;
+            record.set(prefix + "_count", static_cast<double>(histogram.get_count()));
+            record.set(prefix + "_p50_ns", static_cast<double>(histogram.get_percentile(50.)));
+            record.set(prefix + "_p90_ns", static_cast<double>(histogram.get_percentile(90.)));
+            record.set(prefix + "_p99_ns", static_cast<double>(histogram.get_percentile(99.)));
+            record.set(prefix + "_p999_ns", static_cast<double>(histogram.get_percentile(99.9)));
+        }
+        if (point.false_counted) {
+            record.set("false_conflicts", static_cast<double>(point.false_conflicts));
+            record.set("false_conflict_rate", point.false_rate);
+        }
+        record.set("peak_rss_bytes", point.peak_bytes);
+        record.set("alloc_bytes_per_tx", point.alloc_bytes);
+        record.set("allocs_per_tx", per_commit(point, static_cast<double>(res.heap.count)));
+        record.set("retained_bytes_per_tx", per_commit(point, res.heap.get_retained()));
+        record.set("region_overhead_bytes", point.overhead);
+        if (baseline) {
+            record.set("baseline_alloc_ratio", point.growth[0]);
+            record.set("baseline_rss_ratio", point.growth[1]);
+            record.set("baseline_memory_regression", point.bloated ? 1. : 0.);
+        }
+        for (size_t e = 0; config.counters && e < PerfCounters::nbevents; ++e)
+            record.set(::std::string{PerfCounters::names[e]} + "_per_tx", per_tx(point, static_cast<PerfCounters::Event>(e)));
+        if (timed) {
+            record.set("commits", point.commit);
+            record.set("fairness", Summary{point.fairnesses});
+            ::std::string series;
+            for (auto value: point.timeline)
+                series += (series.empty() ? "" : " ") + ::std::to_string(static_cast<uint_fast64_t>(value));
+            record.set("timeline_txps", series);
+        }
+    }
+    /** Run one measurement of a library, print its results and add its record to the report; shared by the isolated and the in-process evaluations.
+     * @param path   Path of the library
+     * @param loaded Library, loaded on first use
+     * @param p      Measurement index
+     * @return Whether the library passed the correctness checks (the violation is printed otherwise)
+    **/
+    bool evaluate_at(::std::string const& path, ::std::optional<TransactionalLibrary>& loaded, size_t p) {
+        Point point;
+        point.c = p / nbshapes;
+        point.s = p % nbshapes;
+        auto const& shape = shapes[point.s];
+        point.nbworkers  = thread_counts[point.c];
+        point.nbtxperwrk = config.get_txperworker(point.nbworkers);
+        point.pertxdiv   = static_cast<double>(point.nbworkers) * static_cast<double>(point.nbtxperwrk);
+        point.last = p + 1 == nbpoints && !grid; // The grid comes last otherwise
+        point.is_reference = &path == &config.libraries.front();
+        if (!loaded)
+            loaded.emplace(path.c_str());
+        auto const& tl = *loaded;
+        // Initialize workload
+        auto const created = Allocations::snapshot();
+        auto workload = make_workload(config, tl, point.nbworkers, point.nbtxperwrk, shape);
+        auto const creation = Allocations::snapshot() - created;
+        point.cpus = config.placement.assign(topology, point.nbworkers);
+        for (auto cpu: point.cpus)
+            point.cpulist += (point.cpulist.empty() ? "" : " ") + ::std::to_string(cpu);
+        // Metadata of a region like the workload's: retained heap bytes beyond the first segment, once created
+        point.overhead = ::std::nan("");
+        if (Allocations::is_hooked()) {
+            auto const& region = workload->get_tm();
+            if (sized) { // A second region of that size may not fit in memory, and the workload allocates nothing else
+                point.overhead = creation.get_retained() - static_cast<double>(region.get_size());
+            } else {
+                auto before = Allocations::snapshot();
+                TransactionalMemory probe{tl, region.get_align(), region.get_size()};
+                point.overhead = (Allocations::snapshot() - before).get_retained() - static_cast<double>(region.get_size());
+            }
+        }
+        STM::tm_counters counters_before; // Library-side counters, if it exports them
+        point.counted = tl.get_counters(counters_before);
+        point.peak_reset = config.memory && Resident::reset_peak(); // Otherwise the peak includes the previous measurements
+        // Actual performance measurements and correctness check
+        MeasureSetup setup;
+        setup.nbthreads    = static_cast<unsigned int>(point.nbworkers);
+        setup.nbrepeats    = static_cast<unsigned int>(config.nbrepeats);
+        setup.nbwarmups    = static_cast<unsigned int>(config.nbwarmups);
+        setup.seed         = seed;
+        setup.maxtick_init = maxtick_init[p];
+        setup.maxtick_perf = maxtick_perf[p];
+        setup.maxtick_chck = maxtick_chck[p];
+        setup.duration     = duration;
+        setup.interval     = interval;
+        setup.latency      = latency;
+        setup.counters     = config.counters;
+        setup.cpus         = point.cpus;
+        point.res = measure(*workload, setup);
+        // Check false negative-free correctness
+        if (unlikely(point.res.error)) {
+            ::std::cout << "⎩ " << point.res.error << ::std::endl;
+            return false;
+        }
+        point.peak = config.memory ? Resident::get_peak() : 0;
+        STM::tm_counters counters_after;
+        tl.get_counters(counters_after);
+        point.false_counted = point.counted && counters_after.false_conflicts != STM::tm_uncounted; // Optional in the library too
+        point.false_conflicts = counters_after.false_conflicts - counters_before.false_conflicts;
+        point.library_aborts = counters_after.aborts - counters_before.aborts;
+        point.false_rate = point.library_aborts > 0 ? static_cast<double>(point.false_conflicts) / static_cast<double>(point.library_aborts) : ::std::nan("");
+        point.tx_types = workload->get_tx_types();
+        // Compute statistics over the repetitions, compare, print and record them
+        summarize(point, p);
+        auto record = identify(point, path, *workload, shape);
+        compare(point, record);
+        if (compact) {
+            print_compact(point, shape);
+        } else {
+            print_detailed(point);
+        }
+        fill(point, record);
+        report.add(::std::move(record));
+        grid_throughputs[p] = point.throughput.median;
+        grid_aborts[p] = point.total.get_abort_rate();
+        return true;
+    }
+    /** Send the record of the measurement just evaluated, and the state the next measurements need, from the isolated child to the parent.
+     * @param isolation    Isolation of the child
+     * @param p            Measurement index
+     * @param is_reference Whether the library is the reference
+    **/
+    [[noreturn]] void send(Isolation& isolation, size_t p, bool is_reference) {
+        Record state;
+        if (is_reference) {
+            state.set("maxtick_init", static_cast<double>(maxtick_init[p]));
+            state.set("maxtick_perf", static_cast<double>(maxtick_perf[p]));
+            state.set("maxtick_chck", static_cast<double>(maxtick_chck[p]));
+            state.set("reference", reference[p]);
+        }
+        state.set("single", single[p % nbshapes]);
+        state.set("grid_throughput", grid_throughputs[p]);
+        state.set("grid_abort_rate", grid_aborts[p]);
+        state.set("slowdown", slowdown ? 1. : 0.);
+        state.set("regression", regression ? 1. : 0.);
+        Report results;
+        results.add(report.get_records().back());
+        results.add(::std::move(state));
+        ::std::ostringstream text;
+        results.write_json(text);
+        isolation.finish(text.str());
+    }
+    /** Collect, in the parent, the results of a measurement evaluated by an isolated child; or record its failure.
+     * @param isolation Isolation of the forked child
+     * @param path      Path of the library
+     * @param p         Measurement index
+    **/
+    void collect(Isolation& isolation, ::std::string const& path, size_t p) {
+        auto const is_reference = &path == &config.libraries.front();
+        auto const nbworkers = thread_counts[p / nbshapes];
+        auto const last = p + 1 == nbpoints && !grid;
+        ::std::string message;
+        int detail;
+        auto status = isolation.wait(::std::chrono::seconds{config.isolate_timeout}, message, detail);
+        if (status == Isolation::Status::done) {
+            ::std::istringstream text{message};
+            auto results = Report::read_json(text);
+            auto& records = results.get_records();
+            if (likely(records.size() == 2)) {
+                auto& state = records[1];
+                auto update = [&](char const* key, auto& target) { // Take the child's copy of some state
+                    auto value = state.get(key);
+                    if (value && ::std::holds_alternative<double>(*value))
+                        target = static_cast<::std::remove_reference_t<decltype(target)>>(::std::get<double>(*value));
+                };
+                update("maxtick_init", maxtick_init[p]);
+                update("maxtick_perf", maxtick_perf[p]);
+                update("maxtick_chck", maxtick_chck[p]);
+                update("reference", reference[p]);
+                update("single", single[p % nbshapes]);
+                update("grid_throughput", grid_throughputs[p]);
+                update("grid_abort_rate", grid_aborts[p]);
+                double flag = 0.;
+                update("slowdown", flag);
+                slowdown = slowdown || flag > 0.;
+                flag = 0.;
+                update("regression", flag);
+                regression = regression || flag > 0.;
+                report.add(records[0]);
+                return;
+            }
+            status = Isolation::Status::failed;
+        }
+        // The child printed what it could, we close the block and record the failure
+        ::std::ostringstream failure;
+        switch (status) {
+        case Isolation::Status::timeout:
+            failure << "timed out after " << config.isolate_timeout << " s";
+            break;
+        case Isolation::Status::crashed:
+            failure << "killed by signal " << detail << " (" << ::strsignal(detail) << ")";
+            break;
+        default:
+            failure << "exited with code " << detail;
+            break;
+        }
+        ::std::cout << (last ? "⎩ " : "⎪ ") << "*** Evaluation process " << failure.str() << " (" << nbworkers << " thread(s)) ***" << ::std::endl;
+        failed = ::std::max(failed, status == Isolation::Status::failed && detail == 1 ? 1 : 2);
+        if (is_reference) // The other libraries run this measurement without timeouts, and without a speedup
+            no_reference[p] = true;
+        Record record;
+        record.set("library", path);
+        record.set("workload", config.workload);
+        record.set("reference", is_reference ? 1. : 0.);
+        record.set("threads", static_cast<double>(nbworkers));
+        record.set("failure", failure.str());
+        report.add(::std::move(record));
+    }
+    /** Print the throughputs and abort rates of the current library by reads and writes: one table per thread count and region size.
+    **/
+    void print_grid() const {
+        auto const nbsizes = config.region_sizes.size();
+        size_t nbcols = 0;
+        while (nbcols < nbshapes && shapes[nbcols].reads == shapes[0].reads && shapes[nbcols].region == shapes[0].region)
+            ++nbcols;
+        auto const nbrows = nbshapes / nbsizes / nbcols;
+        auto cell = [](::std::string text) { // Right-aligned in a fixed-width column
+            return ::std::string(text.size() < 20 ? 20 - text.size() : 1, ' ') + text;
+        };
+        for (size_t c = 0; c < thread_counts.size(); ++c) {
+            for (size_t z = 0; z < nbsizes; ++z) {
+                ::std::cout << "⎪ " << thread_counts[c] << " thread(s), " << config.region_sizes[z] << " MiB: TX/s (abort rate) by reads (rows) and writes (columns)" << ::std::endl;
+                ::std::cout << "⎪       ";
+                for (size_t w = 0; w < nbcols; ++w)
+                    ::std::cout << cell(::std::to_string(shapes[w].writes) + "W");
+                ::std::cout << ::std::endl;
+                for (size_t r = 0; r < nbrows; ++r) {
+                    auto const first = c * nbshapes + (z * nbrows + r) * nbcols; // Measurement of the row's first column
+                    auto const end = c + 1 == thread_counts.size() && z + 1 == nbsizes && r + 1 == nbrows;
+                    auto label = ::std::to_string(shapes[first % nbshapes].reads) + "R";
+                    ::std::cout << (end ? "⎩ " : "⎪ ") << ::std::string(label.size() < 6 ? 6 - label.size() : 0, ' ') << label;
+                    for (size_t w = 0; w < nbcols; ++w) {
+                        ::std::ostringstream text;
+                        text << ::std::setprecision(3) << grid_throughputs[first + w] << " (" << (grid_aborts[first + w] * 100.) << " %)";
+                        ::std::cout << cell(text.str());
+                    }
+                    ::std::cout << ::std::endl;
+                }
+            }
+        }
+    }
+public:
+    /** Run parameters constructor.
+     * @param config   Run parameters
+     * @param topology CPU topology of the machine
+    **/
+    Evaluation(Config const& config, Topology const& topology):
+        config{config}, topology{topology},
+        thread_counts{config.get_thread_counts(topology.get_cpus().size())},
+        oversubscribed{!config.oversubscribe.empty()},
+        shapes{config.get_shapes()}, nbshapes{shapes.size()},
+        sized{config.workload == "region" || config.workload == "txsize"},
+        grid{config.workload == "txsize"},
+        compact{config.sweep > 0 || oversubscribed || nbshapes > 1},
+        latency{config.latency || oversubscribed},
+        seed{static_cast<Seed>(config.seed)},
+        duration{static_cast<Chrono::Tick>(config.duration) * 1000000},
+        interval{static_cast<Chrono::Tick>(config.interval) * 1000000},
+        timed{duration > 0},
+        nbpoints{thread_counts.size() * nbshapes},
+        reference(nbpoints), maxtick_init(nbpoints, Chrono::invalid_tick), maxtick_perf(nbpoints, Chrono::invalid_tick), maxtick_chck(nbpoints, Chrono::invalid_tick), no_reference(nbpoints, false),
+        slowdown{false}, regression{false}, failed{0} {}
+public:
+    /** Print the run parameters, and load the baseline if any.
+    **/
+    void print_header() {
+        auto const clk_res = Chrono::get_resolution();
+        if (oversubscribed) {
+            ::std::cout << "⎧ #worker threads:     ";
+            for (size_t c = 0; c < thread_counts.size(); ++c)
+                ::std::cout << (c > 0 ? ", " : "") << thread_counts[c] << " (" << config.oversubscribe[c] << "x)";
+            ::std::cout << " on " << (thread_counts[0]) << " CPU(s)" << ::std::endl;
+            if (timed) {
+                ::std::cout << "⎪ Duration:            " << config.duration << " ms (counted every " << config.interval << " ms)" << ::std::endl;
+            } else if (config.nbtxperwrk > 0) {
+                ::std::cout << "⎪ #TX per worker:      " << config.nbtxperwrk << ::std::endl;
+            } else {
+                ::std::cout << "⎪ #TX (all workers):   " << config.nbtx << ::std::endl;
+            }
+        } else if (timed) {
+            ::std::cout << "⎧ #worker threads:     " << (config.sweep == 0 ? ::std::to_string(config.nbworkers) : "1 to " + ::std::to_string(config.sweep)) << ::std::endl;
+            ::std::cout << "⎪ Duration:            " << config.duration << " ms (counted every " << config.interval << " ms)" << ::std::endl;
+        } else if (config.sweep == 0) {
+            ::std::cout << "⎧ #worker threads:     " << config.nbworkers << ::std::endl;
+            ::std::cout << "⎪ #TX per worker:      " << config.get_txperworker(config.nbworkers) << ::std::endl;
+        } else {
+            ::std::cout << "⎧ #worker threads:     1 to " << config.sweep << ::std::endl;
+            if (config.nbtxperwrk > 0) {
+                ::std::cout << "⎪ #TX per worker:      " << config.nbtxperwrk << ::std::endl;
+            } else {
+                ::std::cout << "⎪ #TX (all workers):   " << config.nbtx << ::std::endl;
+            }
+        }
+        ::std::cout << "⎪ #repetitions:        " << config.nbrepeats;
+        if (config.nbwarmups > 0)
+            ::std::cout << " (after " << config.nbwarmups << " warm-up)";
+        ::std::cout << ::std::endl;
+        ::std::cout << "⎪ Workload:            " << config.workload << ::std::endl;
+        if (config.workload == "bank") {
+            ::std::cout << "⎪ Initial #accounts:   " << config.nbaccounts << " per worker" << ::std::endl;
+            ::std::cout << "⎪ Expected #accounts:  " << config.expnbaccounts << " per worker" << ::std::endl;
+            ::std::cout << "⎪ Initial balance:     " << config.init_balance << ::std::endl;
+            ::std::cout << "⎪ Long TX probability: " << config.prob_long << ::std::endl;
+            ::std::cout << "⎪ Allocation TX prob.: " << config.prob_alloc << ::std::endl;
+            ::std::cout << "⎪ Account skew:        ";
+            switch (config.skew) {
+            case Skew::Kind::zipf:
+                ::std::cout << "Zipf, theta " << config.zipf_theta << ::std::endl;
+                break;
+            case Skew::Kind::hotset:
+                ::std::cout << (config.hot_prob * 100.) << "% on " << (config.hot_fraction * 100.) << "% of the accounts" << ::std::endl;
+                break;
+            default:
+                ::std::cout << "uniform" << ::std::endl;
+                break;
+            }
+            ::std::cout << "⎪ Long TX reads:       " << (config.scan ? "one scan per segment" : "one account at a time") << ::std::endl;
+        } else if (sized) {
+            ::std::cout << "⎪ Region size(s):      ";
+            for (size_t s = 0; s < config.region_sizes.size(); ++s)
+                ::std::cout << (s > 0 ? ", " : "") << config.region_sizes[s];
+            ::std::cout << " MiB" << ::std::endl;
+            if (grid) {
+                ::std::cout << "⎪ Reads per TX:        1 to " << config.max_reads << ::std::endl;
+                ::std::cout << "⎪ Writes per TX:       0 to " << config.max_writes << ::std::endl;
+            } else {
+                ::std::cout << "⎪ Update TX prob.:     " << config.prob_update << ::std::endl;
+            }
+        } else if (config.workload != "kmeans") {
+            ::std::cout << "⎪ #keys:               " << config.nbkeys << ::std::endl;
+            ::std::cout << "⎪ Update TX prob.:     " << config.prob_update << ::std::endl;
+        }
+        Waiting::set_policy(config.waiting);
+        ::std::cout << "⎪ Harness waiting:     " << Waiting::get_name() << ::std::endl;
+        if (config.placement.is_pinned())
+            ::std::cout << "⎪ Thread placement:    " << config.placement.get_name() << " (" << topology.get_cpus().size() << " CPUs, " << topology.get_nbcores() << " cores, " << topology.get_nbpackages() << " package(s))" << ::std::endl;
+        if (!config.baseline.empty()) {
+            baseline = Report::read_json(config.baseline);
+            ::std::cout << "⎪ Baseline:            " << config.baseline << " (" << baseline->get_records().size() << " record(s), tolerance " << (config.tolerance * 100.) << " %)" << ::std::endl;
+        }
+        ::std::cout << "⎪ Slow trigger factor: " << config.slow_factor << ::std::endl;
         ::std::cout << "⎪ Clock resolution:    ";
         if (unlikely(clk_res == Chrono::invalid_tick)) {
             ::std::cout << "<unknown>" << ::std::endl;
@@ -295,50 +1228,30 @@ int main(int argc, char** argv) {
             ::std::cout << clk_res << " ns" << ::std::endl;
         }
         ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
-        // Library evaluations
-        double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
-        auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
-        auto maxtick_init = Chrono::invalid_tick;
-        auto maxtick_perf = Chrono::invalid_tick;
-        auto maxtick_chck = Chrono::invalid_tick;
-        for (auto i = 2; i < argc; ++i) {
-            ::std::cout << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
-            // Load TM library
-            TransactionalLibrary tl{argv[i]};
-            // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
-            WorkloadBank bank{tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc};
+    }
+    /** Evaluate one library at every thread count and shape.
+     * @param path Path of the library, one of 'config.libraries'
+     * @return Whether the library passed the correctness checks in this process (a violation in an isolated child only counts as a failure)
+    **/
+    bool evaluate(::std::string const& path) {
+        auto const is_reference = &path == &config.libraries.front();
+        ::std::cout << "⎧ Evaluating '" << path << "'" << (is_reference ? " (reference)" : "") << "..." << ::std::endl;
+        ::std::optional<TransactionalLibrary> loaded; // In the process running the measurements: this one, or each isolated child
+        single.assign(nbshapes, 0.);
+        grid_throughputs.assign(nbpoints, 0.);
+        grid_aborts.assign(nbpoints, 0.);
+        for (size_t p = 0; p < nbpoints; ++p) {
+            Isolation isolation; // Process running this measurement, if isolated
+            if (config.isolate && !isolation.fork()) { // Parent: collect the results of the child and move on
+                collect(isolation, path, p);
+                continue;
+            }
             try {
-                // Actual performance measurements and correctness check
-                auto res = measure(bank, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck);
-                // Check false negative-free correctness
-                auto error = ::std::get<0>(res);
-                if (unlikely(error)) {
-                    ::std::cout << "⎩ " << error << ::std::endl;
-                    return 1;
-                }
-                // Print results
-                auto tick_init = ::std::get<1>(res);
-                auto tick_perf = ::std::get<2>(res);
-                auto tick_chck = ::std::get<3>(res);
-                auto perfdbl = static_cast<double>(tick_perf);
-                ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
-                if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
-                    maxtick_init = slow_factor * tick_init;
-                    if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_init;
-                    maxtick_perf = slow_factor * tick_perf;
-                    if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_perf;
-                    maxtick_chck = slow_factor * tick_chck;
-                    if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_chck;
-                    reference = perfdbl;
-                } else { // Compare with reference performance
-                    ::std::cout << " -> " << (reference / perfdbl) << " speedup";
-                }
-                ::std::cout << ::std::endl;
-                ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
-            } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
+                if (!evaluate_at(path, loaded, p))
+                    return false;
+                if (config.isolate) // Child
+                    send(isolation, p, is_reference);
+            } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit (with 2, not the code of a violation)
                 ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
                 ::std::cerr << "⎩ " << err.what() << ::std::endl;
 #ifdef __APPLE__
@@ -348,7 +1261,62 @@ int main(int argc, char** argv) {
 #endif
             }
         }
+        if (grid)
+            print_grid();
+        return true;
+    }
+    /** Write the report, and print the overall verdict.
+     * @return Program return code
+    **/
+    int finish() {
+        report.write(config.format, config.output);
+        if (failed > 0) {
+            ::std::cout << "*** Some evaluation(s) failed ***" << ::std::endl;
+            return failed;
+        }
+        if (slowdown)
+            ::std::cout << "*** Significant slowdown against the baseline ***" << ::std::endl;
+        if (regression)
+            ::std::cout << "*** Memory regression against the baseline ***" << ::std::endl;
+        if (slowdown || regression)
+            return 3;
         return 0;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Program entry point.
+ * @param argc Arguments count
+ * @param argv Arguments values
+ * @return Program return code
+**/
+int main(int argc, char** argv) {
+    try {
+        // Parse command line option(s) and configuration file(s)
+        Config config;
+        try {
+            config.parse(argc, argv);
+        } catch (Exception::Config const& err) {
+            if (!config.culprit.empty())
+                ::std::cout << err.what() << ": '" << config.culprit << "'" << ::std::endl;
+            Config::usage(argc > 0 ? argv[0] : "grading");
+            return 1;
+        }
+        if (config.help) {
+            Config::usage(argc > 0 ? argv[0] : "grading");
+            return 0;
+        }
+        Allocations::enable(config.memory);
+        // Print run parameters, then evaluate every library
+        Topology const topology;
+        Evaluation evaluation{config, topology};
+        evaluation.print_header();
+        for (auto&& path: config.libraries) {
+            if (!evaluation.evaluate(path))
+                return 1;
+        }
+        return evaluation.finish();
     } catch (::std::exception const& err) {
         ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
         ::std::cerr << "⎩ " << err.what() << ::std::endl;
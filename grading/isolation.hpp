@@ -0,0 +1,163 @@
+/**
+ * @file   isolation.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Evaluation of one measurement in a forked child process, which sends its results back over a pipe,
+ * so that a crash, a hang or the heap left behind by a library does not affect the following measurements.
+**/
+
+#pragma once
+
+// External headers
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+extern "C" {
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Isolation, Any, "process isolation exception");
+    EXCEPTION(IsolationFork, Isolation, "unable to fork an evaluation process");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** Forked evaluation process, seen from the parent and from the child.
+**/
+class Isolation final: private NonCopyable {
+public:
+    /** How the child ended.
+    **/
+    enum class Status {
+        done,    // Sent its results and exited normally
+        failed,  // Exited with a non-zero code, or without sending its results
+        crashed, // Killed by a signal
+        timeout  // Killed by the parent after the timeout
+    };
+private:
+    pid_t pid; // Child process ID in the parent, 0 in the child (and before forking)
+    int   fd;  // Read end of the pipe in the parent, write end in the child, -1 before forking
+public:
+    /** Not forked yet constructor.
+    **/
+    Isolation(): pid{0}, fd{-1} {}
+    /** Close the pipe, and reap the child if still running.
+    **/
+    ~Isolation() noexcept {
+        if (fd >= 0)
+            ::close(fd);
+        if (pid > 0) {
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+        }
+    }
+public:
+    /** Fork the evaluation process, after flushing the standard outputs so that nothing gets printed twice.
+     * @return Whether the caller is the child
+    **/
+    bool fork() {
+        int pipefd[2];
+        if (unlikely(::pipe(pipefd) != 0))
+            throw Exception::IsolationFork{};
+        ::std::cout << ::std::flush;
+        ::std::cerr << ::std::flush;
+        ::std::fflush(nullptr);
+        pid = ::fork();
+        if (unlikely(pid < 0)) {
+            pid = 0;
+            ::close(pipefd[0]);
+            ::close(pipefd[1]);
+            throw Exception::IsolationFork{};
+        }
+        if (pid == 0) { // Child
+            ::close(pipefd[0]);
+            fd = pipefd[1];
+            return true;
+        }
+        ::close(pipefd[1]);
+        fd = pipefd[0];
+        return false;
+    }
+    /** [child] Send the results to the parent and exit, without running the destructors of the parent's state.
+     * @param message Results to send
+    **/
+    [[noreturn]] void finish(::std::string const& message) noexcept {
+        ::std::cout << ::std::flush;
+        ::std::cerr << ::std::flush;
+        ::std::fflush(nullptr);
+        for (size_t done = 0; done < message.size();) {
+            auto res = ::write(fd, message.data() + done, message.size() - done);
+            if (res < 0 && errno == EINTR)
+                continue;
+            if (unlikely(res <= 0))
+                ::_exit(1);
+            done += static_cast<size_t>(res);
+        }
+        ::_exit(0);
+    }
+    /** [parent] Collect the results of the child, killing it if it runs past the timeout.
+     * @param timeout Time the child may run, from now
+     * @param message Results sent by the child (complete only if done)
+     * @param detail  Exit code if failed, signal number if crashed
+     * @return How the child ended
+    **/
+    Status wait(::std::chrono::seconds timeout, ::std::string& message, int& detail) {
+        auto const deadline = ::std::chrono::steady_clock::now() + timeout;
+        auto expired = false;
+        char buffer[4096];
+        while (true) { // Read until the child closes its end, i.e. exits
+            auto left = ::std::chrono::duration_cast<::std::chrono::milliseconds>(deadline - ::std::chrono::steady_clock::now()).count();
+            if (left <= 0) {
+                expired = true;
+                break;
+            }
+            struct ::pollfd event{fd, POLLIN, 0};
+            auto res = ::poll(&event, 1, static_cast<int>(left < 1000 ? left : 1000));
+            if (res < 0 && errno != EINTR)
+                break;
+            if (res <= 0)
+                continue;
+            auto size = ::read(fd, buffer, sizeof(buffer));
+            if (size < 0 && errno == EINTR)
+                continue;
+            if (size <= 0)
+                break;
+            message.append(buffer, static_cast<size_t>(size));
+        }
+        if (expired)
+            ::kill(pid, SIGKILL);
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR);
+        pid = 0;
+        detail = 0;
+        if (expired)
+            return Status::timeout;
+        if (WIFSIGNALED(status)) {
+            detail = WTERMSIG(status);
+            return Status::crashed;
+        }
+        detail = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+        return detail == 0 && !message.empty() ? Status::done : Status::failed;
+    }
+};
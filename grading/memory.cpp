@@ -0,0 +1,237 @@
+/**
+ * @file   memory.cpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Counting hooks of the 'malloc' family (glibc only), which the loaded transactional libraries bind to as well.
+ * Each running thread counts in a cache line of its own, given back when it terminates and summed on demand; 'operator new' goes through 'malloc'.
+**/
+
+// External headers
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+extern "C" {
+#include <malloc.h>
+}
+
+// Internal headers
+#include "memory.hpp"
+
+// -------------------------------------------------------------------------- //
+
+#ifdef __GLIBC__
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void* __libc_valloc(size_t);
+void* __libc_pvalloc(size_t);
+void  __libc_free(void*);
+}
+
+namespace {
+
+/** Counters of one thread, or of all the threads past the last slot.
+**/
+struct alignas(64) Slot {
+    ::std::atomic<uint_fast64_t> count{0};
+    ::std::atomic<uint_fast64_t> bytes{0};
+    ::std::atomic<uint_fast64_t> freed{0};
+    ::std::atomic<bool>          taken{false}; // Whether a running thread owns the slot, the counts stay when it is given back
+};
+
+constexpr size_t nbslots = 1024; // Threads running at the same time with their own slot, the others share 'overflow'
+Slot slots[nbslots];
+Slot overflow;
+::std::atomic<size_t> nbused{0}; // Number of slots ever taken, from the first one
+::std::atomic<bool> enabled{false};
+thread_local Slot* local = nullptr; // Slot of the current thread, claimed on its first call
+
+/** Gives the slot of the current thread back when it terminates.
+**/
+struct Release {
+    ~Release() noexcept {
+        if (local && local != &overflow)
+            local->taken.store(false, ::std::memory_order_release); // The next owner sees our counts
+        local = &overflow; // For the allocations of the thread-local destructors that run after us
+    }
+};
+thread_local Release release;
+
+/** Claim a free slot, or the shared one if there is none left.
+ * @return Claimed slot
+**/
+Slot* claim() noexcept {
+    for (size_t i = 0; i < nbslots; ++i) {
+        if (slots[i].taken.load(::std::memory_order_relaxed))
+            continue;
+        auto expected = false;
+        if (slots[i].taken.compare_exchange_strong(expected, true, ::std::memory_order_acquire, ::std::memory_order_relaxed)) {
+            auto used = nbused.load(::std::memory_order_relaxed);
+            while (used <= i && !nbused.compare_exchange_weak(used, i + 1, ::std::memory_order_relaxed));
+            return &slots[i];
+        }
+    }
+    return &overflow;
+}
+
+/** Get the slot of the current thread.
+ * @return Slot to count in
+**/
+Slot& slot() noexcept {
+    if (unlikely(!local)) {
+        local = claim();
+        (void)&release; // Set after claiming, as registering the destructor may allocate
+    }
+    return *local;
+}
+
+/** Add to a counter of the current thread's slot.
+ * @param slot    Slot of the current thread
+ * @param counter Counter of that slot
+ * @param value   Value to add
+**/
+void add(Slot const& slot, ::std::atomic<uint_fast64_t>& counter, uint_fast64_t value) noexcept {
+    if (unlikely(&slot == &overflow)) {
+        counter.fetch_add(value, ::std::memory_order_relaxed);
+    } else { // Single writer, so no need for a locked read-modify-write
+        counter.store(counter.load(::std::memory_order_relaxed) + value, ::std::memory_order_relaxed);
+    }
+}
+
+/** Count an allocation.
+ * @param ptr Allocated block, 'nullptr' if the allocation failed
+ * @return Allocated block
+**/
+void* allocated(void* ptr) noexcept {
+    if (likely(ptr) && enabled.load(::std::memory_order_relaxed)) {
+        auto& counters = slot();
+        add(counters, counters.count, 1);
+        add(counters, counters.bytes, ::malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+/** Count a deallocation.
+ * @param ptr Block to free, 'nullptr' for none
+**/
+void freeing(void* ptr) noexcept {
+    if (ptr && enabled.load(::std::memory_order_relaxed)) {
+        auto& counters = slot();
+        add(counters, counters.freed, ::malloc_usable_size(ptr));
+    }
+}
+
+}
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    return allocated(__libc_malloc(size));
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    return allocated(__libc_calloc(count, size));
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    if (!enabled.load(::std::memory_order_relaxed))
+        return __libc_realloc(ptr, size);
+    auto old = ptr ? ::malloc_usable_size(ptr) : 0;
+    auto res = __libc_realloc(ptr, size);
+    if (res || size == 0) { // The old block is gone
+        if (old > 0) {
+            auto& counters = slot();
+            add(counters, counters.freed, old);
+        }
+        allocated(res);
+    }
+    return res;
+}
+
+void* reallocarray(void* ptr, size_t count, size_t size) noexcept {
+    size_t total;
+    if (unlikely(__builtin_mul_overflow(count, size, &total))) { // glibc's own goes straight to '__libc_realloc', bypassing our hook
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, total);
+}
+
+void* memalign(size_t align, size_t size) noexcept {
+    return allocated(__libc_memalign(align, size));
+}
+
+void* aligned_alloc(size_t align, size_t size) noexcept {
+    return allocated(__libc_memalign(align, size));
+}
+
+int posix_memalign(void** ptr, size_t align, size_t size) noexcept {
+    if (unlikely(align < sizeof(void*) || (align & (align - 1)) != 0))
+        return EINVAL;
+    auto res = allocated(__libc_memalign(align, size));
+    if (unlikely(!res))
+        return ENOMEM;
+    *ptr = res;
+    return 0;
+}
+
+void* valloc(size_t size) noexcept {
+    return allocated(__libc_valloc(size));
+}
+
+void* pvalloc(size_t size) noexcept {
+    return allocated(__libc_pvalloc(size));
+}
+
+void free(void* ptr) noexcept {
+    freeing(ptr);
+    __libc_free(ptr);
+}
+
+}
+
+Allocations Allocations::snapshot() noexcept {
+    Allocations res;
+    auto add = [&](Slot const& counters) {
+        res.count += counters.count.load(::std::memory_order_relaxed);
+        res.bytes += counters.bytes.load(::std::memory_order_relaxed);
+        res.freed += counters.freed.load(::std::memory_order_relaxed);
+    };
+    auto used = nbused.load(::std::memory_order_relaxed);
+    for (size_t i = 0; i < used && i < nbslots; ++i)
+        add(slots[i]);
+    add(overflow);
+    return res;
+}
+
+bool Allocations::is_hooked() noexcept {
+    return enabled.load(::std::memory_order_relaxed);
+}
+
+void Allocations::enable(bool enable) noexcept {
+    enabled.store(enable, ::std::memory_order_relaxed);
+}
+
+#else
+
+Allocations Allocations::snapshot() noexcept {
+    return Allocations{};
+}
+
+bool Allocations::is_hooked() noexcept {
+    return false;
+}
+
+void Allocations::enable(bool) noexcept {}
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file   memory.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Memory footprint of the process: heap allocations counted by the 'malloc' family hooks of 'memory.cpp',
+ * and resident set size from '/proc/self/status' (Linux only).
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Heap allocations of the whole process, in usable bytes, since its start.
+**/
+class Allocations final {
+public:
+    uint_fast64_t count; // Number of allocations
+    uint_fast64_t bytes; // Number of allocated bytes
+    uint_fast64_t freed; // Number of freed bytes
+public:
+    /** Empty counters constructor.
+    **/
+    Allocations(): count{0}, bytes{0}, freed{0} {}
+public:
+    /** [thread-safe] Get the counters of all the threads, complete for the threads this one synchronized with.
+     * @return Current counters (all zero if not hooked)
+    **/
+    static Allocations snapshot() noexcept;
+    /** Tell whether the allocations are counted, on this platform and with the current setting.
+     * @return Whether the hooks are in place and enabled
+    **/
+    static bool is_hooked() noexcept;
+    /** Turn the counting on or off, before the measurements (the blocks allocated before are not tracked either way).
+     * @param enable Whether to count the allocations
+    **/
+    static void enable(bool enable) noexcept;
+public:
+    /** Get the allocations between an earlier snapshot and this one.
+     * @param other Earlier snapshot
+     * @return Difference
+    **/
+    Allocations operator-(Allocations const& other) const noexcept {
+        Allocations res;
+        res.count = count - other.count;
+        res.bytes = bytes - other.bytes;
+        res.freed = freed - other.freed;
+        return res;
+    }
+    /** Add the allocations of another period.
+     * @param other Allocations to add
+    **/
+    void merge(Allocations const& other) noexcept {
+        count += other.count;
+        bytes += other.bytes;
+        freed += other.freed;
+    }
+    /** Get the number of bytes allocated and not freed.
+     * @return Retained bytes, negative if more was freed
+    **/
+    double get_retained() const noexcept {
+        return static_cast<double>(bytes) - static_cast<double>(freed);
+    }
+};
+
+/** Resident set size of the process (Linux only).
+**/
+class Resident final {
+private:
+    /** Read a field of '/proc/self/status'.
+     * @param key Field name, colon included
+     * @return Value (in bytes), 0 if unknown
+    **/
+    static uint_fast64_t read(char const* key) {
+        ::std::ifstream status{"/proc/self/status"};
+        ::std::string name;
+        uint_fast64_t value;
+        while (status >> name) {
+            if (name == key && status >> value)
+                return value * 1024; // In kB
+            status.ignore(::std::numeric_limits<::std::streamsize>::max(), '\n');
+        }
+        return 0;
+    }
+public:
+    /** Reset the peak resident set size to the current one.
+     * @return Whether the kernel allowed it (otherwise the peak is since the start of the process)
+    **/
+    static bool reset_peak() {
+        ::std::ofstream file{"/proc/self/clear_refs"};
+        return static_cast<bool>(file << "5" << ::std::flush);
+    }
+    /** Get the peak resident set size, since the start or the last reset.
+     * @return Peak size (in bytes), 0 if unknown
+    **/
+    static uint_fast64_t get_peak() {
+        return read("VmHWM:");
+    }
+};
@@ -0,0 +1,214 @@
+/**
+ * @file   perf.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Per-thread hardware performance counters (Linux 'perf_event_open'), unavailable elsewhere or when the kernel denies access,
+ * and per-thread preemption count (Linux 'getrusage').
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <cstring>
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Hardware performance counters of the thread that opened them.
+**/
+class PerfCounters final: private NonCopyable {
+public:
+    /** Counted event enum.
+    **/
+    enum Event: size_t {
+        Cycles,
+        Instructions,
+        CacheMisses, // Last-level cache
+        BranchMisses,
+        ContextSwitches,
+        nbevents
+    };
+    /** Event names, as used in the reports.
+    **/
+    constexpr static char const* names[nbevents] = {"cycles", "instructions", "llc_misses", "branch_misses", "context_switches"};
+    /** Accumulated counts class.
+    **/
+    class Totals final {
+    public:
+        double values[nbevents];    // Accumulated counts (scaled when the kernel multiplexed the counters)
+        bool   available[nbevents]; // Whether each event could be counted
+    public:
+        /** Empty totals constructor.
+         * @param available Initial availability of every event
+        **/
+        Totals(bool available = false) {
+            for (size_t i = 0; i < nbevents; ++i) {
+                values[i] = 0.;
+                this->available[i] = available;
+            }
+        }
+    public:
+        /** Add the counts of another thread, an event staying available only if counted by every thread.
+         * @param other Totals to merge in
+        **/
+        void merge(Totals const& other) noexcept {
+            for (size_t i = 0; i < nbevents; ++i) {
+                values[i] += other.values[i];
+                available[i] = available[i] && other.available[i];
+            }
+        }
+        /** Tell whether at least one event is available.
+         * @return Whether any event is available
+        **/
+        bool any() const noexcept {
+            for (size_t i = 0; i < nbevents; ++i) {
+                if (available[i])
+                    return true;
+            }
+            return false;
+        }
+    };
+private:
+    int    fds[nbevents]; // File descriptor of each counter, -1 if unavailable
+    Totals totals;        // Counts accumulated over all the measured regions
+#if defined(__linux__)
+private:
+    /** Open one counter for the calling thread, on any CPU.
+     * @param type   Event type ('PERF_TYPE_*')
+     * @param config Event configuration
+     * @return File descriptor, -1 on failure
+    **/
+    static int open_one(uint32_t type, uint64_t config) noexcept {
+        perf_event_attr attr;
+        ::std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        auto fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0) { // Typically denied kernel-side counting ('perf_event_paranoid' >= 2), retry user-side only
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        return fd;
+    }
+#endif
+public:
+    /** Closed counters constructor.
+    **/
+    PerfCounters() {
+        for (auto&& fd: fds)
+            fd = -1;
+    }
+    /** Close destructor.
+    **/
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+#endif
+    }
+public:
+    /** Open the counters for the calling thread, the ones the kernel refuses staying unavailable.
+    **/
+    void open() noexcept {
+#if defined(__linux__)
+        fds[Cycles]          = open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[Instructions]    = open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[CacheMisses]     = open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[BranchMisses]    = open_one(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[ContextSwitches] = open_one(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+        for (size_t i = 0; i < nbevents; ++i)
+            totals.available[i] = fds[i] >= 0;
+    }
+    /** Reset and start the open counters.
+    **/
+    void start() noexcept {
+#if defined(__linux__)
+        for (auto fd: fds) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+    /** Stop the open counters and accumulate their counts.
+    **/
+    void stop() noexcept {
+#if defined(__linux__)
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (size_t i = 0; i < nbevents; ++i) {
+            if (fds[i] < 0)
+                continue;
+            uint64_t data[3]; // Value, time enabled, time running
+            if (unlikely(::read(fds[i], data, sizeof(data)) != sizeof(data))) {
+                totals.available[i] = false;
+                continue;
+            }
+            if (data[2] > 0) { // Scale up if the counter was multiplexed
+                totals.values[i] += static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            } else if (data[1] > 0) { // Enabled but never scheduled: unknown count
+                totals.available[i] = false;
+            }
+        }
+#endif
+    }
+    /** Access the accumulated counts.
+     * @return Accumulated counts
+    **/
+    auto const& get_totals() const noexcept {
+        return totals;
+    }
+};
+
+/** Involuntary context switches of the calling thread, i.e. how many times it was preempted.
+**/
+class Preemptions final {
+public:
+    /** Tell whether the count is available on this platform.
+     * @return Whether 'get' counts
+    **/
+    constexpr static bool is_available() noexcept {
+#if defined(__linux__) && defined(RUSAGE_THREAD)
+        return true;
+#else
+        return false;
+#endif
+    }
+    /** Get the number of involuntary context switches of the calling thread so far.
+     * @return Count (0 if unavailable)
+    **/
+    static uint_fast64_t get() noexcept {
+#if defined(__linux__) && defined(RUSAGE_THREAD)
+        struct ::rusage usage;
+        if (likely(::getrusage(RUSAGE_THREAD, &usage) == 0))
+            return static_cast<uint_fast64_t>(usage.ru_nivcsw);
+#endif
+        return 0;
+    }
+};
@@ -0,0 +1,248 @@
+/**
+ * @file   region.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Synthetic workloads over one large region of words: small random transactions scattered over hundreds of MiB
+ * to several GiB, so that a library mapping addresses to a fixed number of locks sees them alias, and transactions
+ * of a given number of random reads and writes, to find where the per-word costs of a library start to dominate.
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "transactional.hpp"
+#include "workload.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Large-region workload class: the region is an array of pairs of words, each pair summing to zero.
+ * Updating transactions move one unit between the two words of two random pairs, read-only ones check that two random pairs still sum to zero.
+**/
+class WorkloadRegion final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = intptr_t;
+private:
+    /** Transaction types, for the transaction statistics.
+    **/
+    enum TxType: size_t {
+        TxRead,
+        TxUpdate
+    };
+    /** Get the size of the first shared segment, rounded down to a whole number of pairs.
+     * @param size Requested size (in bytes)
+     * @return Segment size (in bytes), at least one pair
+    **/
+    constexpr static size_t size(size_t size) noexcept {
+        return (size / (2 * sizeof(Word)) > 0 ? size / (2 * sizeof(Word)) : 1) * 2 * sizeof(Word);
+    }
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  nbpairs;     // Number of pairs of words in the region
+    float   prob_update; // Probability of running an updating transaction
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Large-region workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param region      Size of the shared memory region (in bytes, rounded down to a whole number of pairs)
+     * @param prob_update Probability of running an updating transaction
+    **/
+    WorkloadRegion(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t region, float prob_update): Workload{library, alignof(Word), size(region)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbpairs{size(region) / (2 * sizeof(Word))}, prob_update{prob_update}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+private:
+    /** Read-only transaction, checking two pairs.
+     * @param first  Index of the first pair
+     * @param second Index of the second pair (potentially the same)
+     * @return Whether both pairs sum to zero
+    **/
+    bool read_tx(size_t first, size_t second) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Shared<Word[]> words{tx, tm.get_start()};
+            return words.read(2 * first) + words.read(2 * first + 1) == 0 && words.read(2 * second) + words.read(2 * second + 1) == 0;
+        });
+    }
+    /** Updating transaction, moving one unit from the second to the first word of two pairs.
+     * @param first  Index of the first pair
+     * @param second Index of the second pair (potentially the same)
+    **/
+    void update_tx(size_t first, size_t second) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word[]> words{tx, tm.get_start()};
+            for (auto pair: {first, second}) {
+                words.write(2 * pair, words.read(2 * pair) + 1);
+                words.write(2 * pair + 1, words.read(2 * pair + 1) - 1);
+            }
+        });
+    }
+public:
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"read", "update"};
+    }
+    /** The region is zeroed by its creation and every transaction keeps the pairs summing to zero, so there is only the two ends to check.
+    **/
+    virtual char const* init() const {
+        if (unlikely(!read_tx(0, nbpairs - 1)))
+            return "Violated consistency (check that the shared memory region is zeroed on creation)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk random transactions (or until the deadline) until completion.
+     * @param uid  Worker unique ID
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::uniform_int_distribution<size_t> pair_dist{0, nbpairs - 1};
+        for (size_t cntr = 0; next(uid, cntr, nbtxperwrk); ++cntr) {
+            auto first = pair_dist(engine);
+            auto second = pair_dist(engine);
+            if (update_dist(engine)) {
+                TxRecorder::set_type(TxUpdate);
+                update_tx(first, second);
+            } else {
+                TxRecorder::set_type(TxRead);
+                if (unlikely(!read_tx(first, second)))
+                    return "Violated isolation or atomicity";
+            }
+        }
+        return nullptr;
+    }
+    /**
+     * Test in which each worker increments pairs only it touches, while the others do the same on pairs that may share their locks.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbtxperwrk = 100;
+        char const* error = nullptr;
+        ::std::minstd_rand engine{seed};
+        auto const nbowned = (nbpairs + nbworkers - 1 - uid) / nbworkers; // Pairs uid, uid + nbworkers, ...
+
+        barrier.sync();
+        for (size_t i = 0; nbowned > 0 && i < nbtxperwrk && !error; ++i) {
+            auto pair = uid + nbworkers * ::std::uniform_int_distribution<size_t>{0, nbowned - 1}(engine);
+
+            // We fetch the current value of the pair, nobody else writes it during the check,
+            auto last = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                return words.read(2 * pair);
+            });
+
+            // Increment it, and check that we see exactly our increment.
+            update_tx(pair, pair);
+            auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                return words.read(2 * pair) == last + 2 && words.read(2 * pair + 1) == -(last + 2);
+            });
+            if (unlikely(!correct))
+                error = "Violated consistency, isolation or atomicity";
+        }
+        barrier.sync();
+        return error;
+    }
+};
+
+/** Transaction-size workload class: each transaction reads a fixed number of random words of the region, then writes a fixed number of random words.
+**/
+class WorkloadTxSize final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = intptr_t;
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t nbwords;    // Number of words in the region
+    size_t nbreads;    // Number of words read per transaction
+    size_t nbwrites;   // Number of words written per transaction, 0 for read-only transactions
+    Barrier barrier;   // Barrier for thread synchronization during 'check'
+public:
+    /** Transaction-size workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param region     Size of the shared memory region (in bytes, rounded down to a whole number of words)
+     * @param nbreads    Number of words read per transaction
+     * @param nbwrites   Number of words written per transaction, 0 for read-only transactions
+    **/
+    WorkloadTxSize(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t region, size_t nbreads, size_t nbwrites): Workload{library, alignof(Word), (region / sizeof(Word) > 0 ? region / sizeof(Word) : 1) * sizeof(Word)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbwords{tm.get_size() / sizeof(Word)}, nbreads{nbreads}, nbwrites{nbwrites}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+public:
+    virtual char const* init() const {
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk transactions (or until the deadline) of the configured size, on random words.
+     * @param uid  Worker unique ID
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> word_dist{0, nbwords - 1};
+        ::std::vector<size_t> indexes(nbreads + nbwrites); // Drawn before the transaction, so that its retries touch the same words
+        auto const mode = nbwrites > 0 ? Transaction::Mode::read_write : Transaction::Mode::read_only;
+        for (size_t cntr = 0; next(uid, cntr, nbtxperwrk); ++cntr) {
+            for (auto& index: indexes)
+                index = word_dist(engine);
+            transactional(tm, mode, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                Word sum = 0;
+                for (size_t i = 0; i < nbreads; ++i)
+                    sum += words.read(indexes[i]);
+                for (size_t i = nbreads; i < nbreads + nbwrites; ++i) // Blind writes, only the size of the write-set matters
+                    words.write(indexes[i], sum + static_cast<Word>(i));
+            });
+        }
+        return nullptr;
+    }
+    /**
+     * Test in which each worker increments words only it touches, in transactions of the configured size that also read everywhere.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbtxperwrk = 100;
+        char const* error = nullptr;
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> word_dist{0, nbwords - 1};
+        auto const nbowned = (nbwords + nbworkers - 1 - uid) / nbworkers; // Words uid, uid + nbworkers, ...
+
+        barrier.sync();
+        for (size_t i = 0; nbowned > 0 && i < nbtxperwrk && !error; ++i) {
+            auto owned = uid + nbworkers * ::std::uniform_int_distribution<size_t>{0, nbowned - 1}(engine);
+            auto last = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                return words.read(owned);
+            });
+            transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                for (size_t r = 0; r < nbreads; ++r)
+                    words.read(word_dist(engine));
+                words.write(owned, words.read(owned) + 1);
+            });
+            auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                return words.read(owned) == last + 1;
+            });
+            if (unlikely(!correct))
+                error = "Violated consistency, isolation or atomicity";
+        }
+        barrier.sync();
+        return error;
+    }
+};
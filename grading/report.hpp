@@ -0,0 +1,348 @@
+/**
+ * @file   report.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Machine-readable (CSV/JSON) reports of the measurements.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Report, Any, "report exception");
+    EXCEPTION(ReportOutput, Report, "unable to write the report");
+    EXCEPTION(ReportInput, Report, "unable to read the report");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** Order statistics over a set of samples.
+**/
+class Summary final {
+public:
+    double min;    // Smallest sample
+    double q1;     // First quartile
+    double median; // Median
+    double q3;     // Third quartile
+    double max;    // Largest sample
+public:
+    /** No samples constructor, every statistic NaN.
+    **/
+    Summary(): min{::std::nan("")}, q1{min}, median{min}, q3{min}, max{min} {}
+    /** Samples constructor.
+     * @param samples Non-empty set of samples (reordered)
+    **/
+    template<class Value> Summary(::std::vector<Value>& samples) {
+        ::std::sort(samples.begin(), samples.end());
+        auto at = [&](size_t pos) { return static_cast<double>(samples[pos]); };
+        auto last = samples.size() - 1;
+        min    = at(0);
+        q1     = at(last / 4);
+        median = at(samples.size() / 2); // Same position as the historical median
+        q3     = at(last - last / 4);
+        max    = at(last);
+    }
+};
+
+/** One line/object of a report: an ordered list of named fields.
+**/
+class Record final {
+public:
+    /** Field value class.
+    **/
+    using Value = ::std::variant<double, ::std::string>;
+private:
+    ::std::vector<::std::pair<::std::string, Value>> fields; // Fields, in insertion order
+public:
+    /** Add (or replace) a field.
+     * @param key   Field name
+     * @param value Field value
+     * @return This record
+    **/
+    Record& set(::std::string const& key, Value value) {
+        for (auto&& field: fields) {
+            if (field.first == key) {
+                field.second = ::std::move(value);
+                return *this;
+            }
+        }
+        fields.emplace_back(key, ::std::move(value));
+        return *this;
+    }
+    /** Add the order statistics of a set of samples, as '<prefix>_min', '<prefix>_q1', etc.
+     * @param prefix  Field name prefix
+     * @param summary Order statistics to add
+     * @return This record
+    **/
+    Record& set(::std::string const& prefix, Summary const& summary) {
+        set(prefix + "_min", summary.min);
+        set(prefix + "_q1", summary.q1);
+        set(prefix + "_median", summary.median);
+        set(prefix + "_q3", summary.q3);
+        set(prefix + "_max", summary.max);
+        return *this;
+    }
+    /** Get a field value.
+     * @param key Field name
+     * @return Pointer to the value, 'nullptr' if missing
+    **/
+    Value const* get(::std::string const& key) const noexcept {
+        for (auto&& field: fields) {
+            if (field.first == key)
+                return &field.second;
+        }
+        return nullptr;
+    }
+    /** Access the fields.
+     * @return Fields, in insertion order
+    **/
+    auto const& get_fields() const noexcept {
+        return fields;
+    }
+};
+
+/** Set of records, written out as CSV or JSON.
+**/
+class Report final {
+public:
+    /** Output format enum class.
+    **/
+    enum class Format {
+        none,
+        csv,
+        json
+    };
+private:
+    ::std::vector<Record> records; // Records, in insertion order
+private:
+    /** Write a number, without losing precision and without the locale getting in the way.
+     * @param out   Output stream
+     * @param value Value to write
+    **/
+    static void write_number(::std::ostream& out, double value) {
+        if (!::std::isfinite(value)) { // JSON has no infinity nor NaN
+            out << "null";
+            return;
+        }
+        ::std::ostringstream text;
+        text.imbue(::std::locale::classic());
+        text << ::std::setprecision(::std::numeric_limits<double>::max_digits10) << value;
+        out << text.str();
+    }
+    /** Write a string, quoted and escaped.
+     * @param out   Output stream
+     * @param value Value to write
+     * @param json  Whether to escape for JSON (backslash) rather than CSV (doubled quote)
+    **/
+    static void write_string(::std::ostream& out, ::std::string const& value, bool json) {
+        out << '"';
+        for (auto c: value) {
+            if (c == '"')
+                out << (json ? '\\' : '"');
+            else if (json && c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+    /** Write a field value.
+     * @param out   Output stream
+     * @param value Value to write
+     * @param json  Whether to escape strings for JSON rather than CSV
+    **/
+    static void write_value(::std::ostream& out, Record::Value const& value, bool json) {
+        if (::std::holds_alternative<double>(value)) {
+            write_number(out, ::std::get<double>(value));
+        } else {
+            write_string(out, ::std::get<::std::string>(value), json);
+        }
+    }
+    /** Read a string, quoted and escaped for JSON.
+     * @param in Input stream, before the opening quote
+     * @return Read string
+    **/
+    static ::std::string read_string(::std::istream& in) {
+        if (unlikely((in >> ::std::ws).get() != '"'))
+            throw Exception::ReportInput{};
+        ::std::string res;
+        while (true) {
+            auto c = in.get();
+            if (unlikely(c == ::std::char_traits<char>::eof()))
+                throw Exception::ReportInput{};
+            if (c == '"')
+                return res;
+            if (c == '\\')
+                c = in.get();
+            res.push_back(static_cast<char>(c));
+        }
+    }
+    /** Read a field value written by 'write_value' in JSON.
+     * @param in Input stream, before the value
+     * @return Read value ('null' read as NaN)
+    **/
+    static Record::Value read_value(::std::istream& in) {
+        auto c = (in >> ::std::ws).peek();
+        if (c == '"')
+            return read_string(in);
+        ::std::string text;
+        while (in && (::std::isalnum(in.peek()) || in.peek() == '.' || in.peek() == '-' || in.peek() == '+'))
+            text.push_back(static_cast<char>(in.get()));
+        if (text == "null")
+            return ::std::nan("");
+        ::std::istringstream number{text};
+        number.imbue(::std::locale::classic());
+        double value;
+        if (unlikely(!(number >> value) || !(number >> ::std::ws).eof()))
+            throw Exception::ReportInput{};
+        return value;
+    }
+    /** Expect a given character, after optional blanks.
+     * @param in       Input stream
+     * @param expected Expected character
+    **/
+    static void expect(::std::istream& in, char expected) {
+        if (unlikely((in >> ::std::ws).get() != expected))
+            throw Exception::ReportInput{};
+    }
+public:
+    /** Read a report written by 'write_json'.
+     * @param path Input file path
+     * @return Read report
+    **/
+    static Report read_json(::std::string const& path) {
+        ::std::ifstream in{path};
+        if (unlikely(!in))
+            throw Exception::ReportInput{};
+        return read_json(in);
+    }
+    /** Read a report written by 'write_json'.
+     * @param in Input stream
+     * @return Read report
+    **/
+    static Report read_json(::std::istream& in) {
+        Report res;
+        expect(in, '[');
+        if ((in >> ::std::ws).peek() == ']')
+            return res;
+        do {
+            Record record;
+            expect(in, '{');
+            if ((in >> ::std::ws).peek() != '}') {
+                do {
+                    auto key = read_string(in);
+                    expect(in, ':');
+                    record.set(key, read_value(in));
+                } while ((in >> ::std::ws).peek() == ',' && in.get());
+            }
+            expect(in, '}');
+            res.add(::std::move(record));
+        } while ((in >> ::std::ws).peek() == ',' && in.get());
+        expect(in, ']');
+        return res;
+    }
+public:
+    /** Add a record.
+     * @param record Record to add
+    **/
+    void add(Record record) {
+        records.push_back(::std::move(record));
+    }
+    /** Access the records.
+     * @return Records, in insertion order
+    **/
+    auto const& get_records() const noexcept {
+        return records;
+    }
+    /** Write the report as CSV, with one column per field name seen in any record.
+     * @param out Output stream
+    **/
+    void write_csv(::std::ostream& out) const {
+        ::std::vector<::std::string> columns;
+        for (auto&& record: records) {
+            for (auto&& field: record.get_fields()) {
+                if (::std::find(columns.begin(), columns.end(), field.first) == columns.end())
+                    columns.push_back(field.first);
+            }
+        }
+        for (size_t i = 0; i < columns.size(); ++i)
+            out << (i > 0 ? "," : "") << columns[i];
+        out << ::std::endl;
+        for (auto&& record: records) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                if (i > 0)
+                    out << ",";
+                auto value = record.get(columns[i]);
+                if (value)
+                    write_value(out, *value, false);
+            }
+            out << ::std::endl;
+        }
+    }
+    /** Write the report as a JSON array of objects.
+     * @param out Output stream
+    **/
+    void write_json(::std::ostream& out) const {
+        out << "[" << ::std::endl;
+        for (size_t i = 0; i < records.size(); ++i) {
+            out << "  {";
+            auto&& fields = records[i].get_fields();
+            for (size_t j = 0; j < fields.size(); ++j) {
+                out << (j > 0 ? ", " : "");
+                write_string(out, fields[j].first, true);
+                out << ": ";
+                write_value(out, fields[j].second, true);
+            }
+            out << "}" << (i + 1 < records.size() ? "," : "") << ::std::endl;
+        }
+        out << "]" << ::std::endl;
+    }
+    /** Write the report in the given format.
+     * @param format Output format
+     * @param path   Output file path, '-' for the standard output
+    **/
+    void write(Format format, ::std::string const& path) const {
+        if (format == Format::none)
+            return;
+        ::std::ofstream file;
+        if (path != "-") {
+            file.open(path);
+            if (unlikely(!file))
+                throw Exception::ReportOutput{};
+        }
+        auto& out = path != "-" ? static_cast<::std::ostream&>(file) : ::std::cout;
+        if (format == Format::csv) {
+            write_csv(out);
+        } else {
+            write_json(out);
+        }
+        if (unlikely(!out))
+            throw Exception::ReportOutput{};
+    }
+};
@@ -0,0 +1,1411 @@
+/**
+ * @file   stamp.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * STAMP-style workloads: sorted linked-list set, chained hash map, red-black tree,
+ * vacation-style reservation system and k-means-style update loop.
+**/
+
+#pragma once
+
+// External headers
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "transactional.hpp"
+#include "workload.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Base class of the workloads maintaining a set of keys.
+**/
+class WorkloadSet: public Workload {
+public:
+    /** Key class alias.
+    **/
+    using Key = size_t;
+protected:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  nbkeys;      // Keys are in [0, nbkeys)
+    float   prob_update; // Probability of running an insertion/removal transaction instead of a lookup
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Set workload constructor.
+     * @param library     Transactional library to use
+     * @param align       Shared memory region required alignment
+     * @param size        Size of the shared memory region to allocate
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys
+     * @param prob_update Probability of running an insertion/removal transaction instead of a lookup
+    **/
+    WorkloadSet(TransactionalLibrary const& library, size_t align, size_t size, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update): Workload{library, align, size}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, prob_update{prob_update}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+protected:
+    /** [thread-safe] Insertion transaction.
+     * @param key Key to insert
+     * @return Whether the key was absent
+    **/
+    virtual bool insert(Key key) const = 0;
+    /** [thread-safe] Removal transaction.
+     * @param key Key to remove
+     * @return Whether the key was present
+    **/
+    virtual bool remove(Key key) const = 0;
+    /** [thread-safe] Lookup transaction.
+     * @param key Key to look for
+     * @return Whether the key is present
+    **/
+    virtual bool contains(Key key) const = 0;
+    /** [thread-safe] Read-only transaction checking every invariant of the data structure.
+     * @return Whether no inconsistency has been found
+    **/
+    virtual bool verify() const = 0;
+protected:
+    /** Transaction types, for the transaction statistics.
+    **/
+    enum TxType: size_t {
+        TxLookup,
+        TxInsert,
+        TxRemove,
+        TxVerify
+    };
+public:
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"lookup", "insert", "remove", "verify"};
+    }
+    /**
+     * Insert every even key (idempotent, every worker runs it) and check the data structure.
+    **/
+    virtual char const* init() const {
+        for (Key key = 0; key < nbkeys; key += 2)
+            insert(key);
+        if (unlikely(!contains(0) || !verify()))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk (or until the deadline) random lookups, insertions and removals, then check the data structure.
+     * @param uid  Worker unique ID
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        ::std::uniform_int_distribution<Key> key_dist{0, nbkeys - 1};
+        for (size_t cntr = 0; next(uid, cntr, nbtxperwrk); ++cntr) {
+            auto key = key_dist(engine);
+            if (update_dist(engine)) {
+                if (insert_dist(engine)) {
+                    TxRecorder::set_type(TxInsert);
+                    insert(key);
+                } else {
+                    TxRecorder::set_type(TxRemove);
+                    remove(key);
+                }
+            } else {
+                TxRecorder::set_type(TxLookup);
+                contains(key);
+            }
+        }
+        TxRecorder::set_type(TxVerify);
+        if (unlikely(!verify()))
+            return "Violated isolation or atomicity";
+        return nullptr;
+    }
+    /**
+     * Test in which each thread updates its own keys (uid, uid + nbworkers, ...) concurrently, so the result of every operation is known in advance.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbtxperwrk = 100;
+
+        char const* error = nullptr;
+        ::std::minstd_rand engine{seed};
+        ::std::vector<Key> keys;
+        for (Key key = uid; key < nbkeys; key += nbworkers)
+            keys.push_back(key);
+
+        // Snapshot the membership of our keys, nobody else modifies them
+        barrier.sync();
+        ::std::vector<bool> present;
+        for (auto key: keys)
+            present.push_back(contains(key));
+
+        // Every operation must return what the private copy predicts
+        if (!keys.empty()) {
+            ::std::uniform_int_distribution<size_t> index_dist{0, keys.size() - 1};
+            ::std::uniform_int_distribution<int> op_dist{0, 2};
+            for (size_t i = 0; i < nbtxperwrk; ++i) {
+                auto index = index_dist(engine);
+                bool expected;
+                bool result;
+                switch (op_dist(engine)) {
+                case 0:
+                    expected = !present[index];
+                    result = insert(keys[index]);
+                    present[index] = true;
+                    break;
+                case 1:
+                    expected = present[index];
+                    result = remove(keys[index]);
+                    present[index] = false;
+                    break;
+                default:
+                    expected = present[index];
+                    result = contains(keys[index]);
+                    break;
+                }
+                if (unlikely(result != expected)) {
+                    error = "Violated consistency, isolation or atomicity";
+                    break;
+                }
+            }
+        }
+
+        // Once everybody is done, the final membership and the structure invariants must hold
+        barrier.sync();
+        for (size_t i = 0; !error && i < keys.size(); ++i) {
+            if (unlikely(contains(keys[i]) != present[i]))
+                error = "Violated consistency";
+        }
+        if (uid == 0 && !error && unlikely(!verify()))
+            error = "Violated consistency";
+        return error;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Sorted linked-list set workload class.
+**/
+class WorkloadList final: public WorkloadSet {
+private:
+    /** Shared list node class (the first shared segment is the head sentinel).
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            size_t dummy0;
+            void*  dummy1;
+        };
+    public:
+        /** Get the node size.
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the node alignment.
+         * @return Node alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Key>   key;  // Key (unused in the head sentinel)
+        Shared<Node*> next; // Next node, with a greater key
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, next{tx, key.after()} {}
+    };
+public:
+    /** Linked-list workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys
+     * @param prob_update Probability of running an insertion/removal transaction instead of a lookup
+    **/
+    WorkloadList(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update): WorkloadSet{library, Node::align(), Node::size(), nbworkers, nbtxperwrk, nbkeys, prob_update} {}
+private:
+    /** Find where a key is or would be in the list.
+     * @param tx  Pending transaction
+     * @param key Key to look for
+     * @return Address of the last node with a smaller key (or the head), address of the node after it (or 'nullptr')
+    **/
+    ::std::pair<void*, Node*> find(Transaction& tx, Key key) const {
+        void* prev = tm.get_start();
+        Node* curr = Node{tx, prev}.next;
+        while (curr) {
+            Node node{tx, curr};
+            if (node.key >= key)
+                break;
+            prev = curr;
+            curr = node.next;
+        }
+        return {prev, curr};
+    }
+protected:
+    virtual bool insert(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto [prev, curr] = find(tx, key);
+            if (curr && Node{tx, curr}.key == key)
+                return false;
+            auto addr = tx.alloc(Node::size());
+            Node node{tx, addr};
+            node.key = key;
+            node.next = curr;
+            Node{tx, prev}.next = reinterpret_cast<Node*>(addr);
+            return true;
+        });
+    }
+    virtual bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto [prev, curr] = find(tx, key);
+            if (!curr)
+                return false;
+            Node node{tx, curr};
+            if (node.key != key)
+                return false;
+            Node{tx, prev}.next = node.next.read();
+            tx.free(curr);
+            return true;
+        });
+    }
+    virtual bool contains(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            auto curr = find(tx, key).second;
+            return curr && Node{tx, curr}.key == key;
+        });
+    }
+    virtual bool verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Node* curr = Node{tx, tm.get_start()}.next;
+            auto first = true;
+            Key last = 0;
+            while (curr) {
+                Node node{tx, curr};
+                Key key = node.key;
+                if (unlikely(key >= nbkeys || (!first && key <= last))) // Keys must be valid and strictly increasing
+                    return false;
+                first = false;
+                last = key;
+                curr = node.next;
+            }
+            return true;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Chained hash map workload class.
+**/
+class WorkloadHashMap final: public WorkloadSet {
+private:
+    /** Shared chain node class.
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            size_t dummy0;
+            size_t dummy1;
+            void*  dummy2;
+        };
+    public:
+        /** Get the node size.
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the node alignment.
+         * @return Node alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Key>   key;   // Key
+        Shared<Key>   value; // Value, always the complement of the key (to detect torn nodes)
+        Shared<Node*> next;  // Next node in the same bucket
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, value{tx, key.after()}, next{tx, value.after()} {}
+    };
+private:
+    size_t nbbuckets; // Number of buckets (the first shared segment is the bucket array)
+private:
+    /** Get the number of buckets for a given number of keys.
+     * @param nbkeys Number of distinct keys
+     * @return Number of buckets (4 keys per bucket at most)
+    **/
+    constexpr static size_t buckets(size_t nbkeys) noexcept {
+        return nbkeys / 4 > 0 ? nbkeys / 4 : 1;
+    }
+public:
+    /** Hash map workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys
+     * @param prob_update Probability of running an insertion/removal transaction instead of a lookup
+    **/
+    WorkloadHashMap(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update): WorkloadSet{library, Node::align(), buckets(nbkeys) * sizeof(Node*), nbworkers, nbtxperwrk, nbkeys, prob_update}, nbbuckets{buckets(nbkeys)} {}
+private:
+    /** Get the head of the bucket of a key.
+     * @param tx  Pending transaction
+     * @param key Key to hash
+     * @return Shared on the bucket head
+    **/
+    Shared<Node*> bucket(Transaction& tx, Key key) const {
+        return Shared<Node*[]>{tx, tm.get_start()}[key % nbbuckets];
+    }
+protected:
+    virtual bool insert(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto head = bucket(tx, key);
+            Node* first = head;
+            for (auto curr = first; curr;) {
+                Node node{tx, curr};
+                if (node.key == key)
+                    return false;
+                curr = node.next;
+            }
+            auto addr = tx.alloc(Node::size());
+            Node node{tx, addr};
+            node.key = key;
+            node.value = ~key;
+            node.next = first;
+            head = reinterpret_cast<Node*>(addr);
+            return true;
+        });
+    }
+    virtual bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Node** link = bucket(tx, key).get();
+            Node* curr = Shared<Node*>{tx, link};
+            while (curr) {
+                Node node{tx, curr};
+                if (node.key == key) {
+                    Shared<Node*>{tx, link} = node.next.read();
+                    tx.free(curr);
+                    return true;
+                }
+                link = node.next.get();
+                curr = node.next;
+            }
+            return false;
+        });
+    }
+    virtual bool contains(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Node* curr = bucket(tx, key);
+            while (curr) {
+                Node node{tx, curr};
+                if (node.key == key)
+                    return true;
+                curr = node.next;
+            }
+            return false;
+        });
+    }
+    virtual bool verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            ::std::vector<Key> seen; // Keys of the current chain
+            for (size_t i = 0; i < nbbuckets; ++i) {
+                seen.clear();
+                Node* curr = Shared<Node*[]>{tx, tm.get_start()}[i];
+                while (curr) {
+                    Node node{tx, curr};
+                    Key key = node.key;
+                    if (unlikely(key >= nbkeys || key % nbbuckets != i || node.value != ~key)) // Valid, in the right bucket and untorn
+                        return false;
+                    for (auto other: seen) {
+                        if (unlikely(other == key)) // No duplicate
+                            return false;
+                    }
+                    seen.push_back(key);
+                    curr = node.next;
+                }
+            }
+            return true;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Red-black tree workload class.
+**/
+class WorkloadTree final: public WorkloadSet {
+private:
+    /** Shared tree node class.
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            size_t dummy0;
+            size_t dummy1;
+            size_t dummy2;
+            void*  dummy3;
+            void*  dummy4;
+            void*  dummy5;
+        };
+    public:
+        /** Get the node size.
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the node alignment.
+         * @return Node alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Key>   key;    // Key
+        Shared<Key>   value;  // Value, always the complement of the key (to detect torn nodes)
+        Shared<Key>   red;    // Whether the node is red (non-zero) or black (zero)
+        Shared<Node*> left;   // Left child, with smaller keys
+        Shared<Node*> right;  // Right child, with greater keys
+        Shared<Node*> parent; // Parent node ('nullptr' for the root)
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, value{tx, key.after()}, red{tx, value.after()}, left{tx, red.after()}, right{tx, left.after()}, parent{tx, right.after()} {}
+    };
+    /** Red-black tree operations in one transaction (the null leaves are black), as in the classic textbook algorithms.
+    **/
+    class Tree final {
+    private:
+        Transaction&  tx;   // Bound transaction
+        Shared<Node*> root; // Root node (in the first shared segment)
+    public:
+        /** Binding constructor.
+         * @param tx    Associated pending transaction
+         * @param start Address of the root pointer
+        **/
+        Tree(Transaction& tx, void* start): tx{tx}, root{tx, start} {}
+    public:
+        Node at(Node* node) const {
+            return Node{tx, node};
+        }
+        Node* get_root() const {
+            return root;
+        }
+        Node* left(Node* node) const {
+            return node ? at(node).left.read() : nullptr;
+        }
+        Node* right(Node* node) const {
+            return node ? at(node).right.read() : nullptr;
+        }
+        Node* parent(Node* node) const {
+            return node ? at(node).parent.read() : nullptr;
+        }
+        bool is_red(Node* node) const {
+            return node && at(node).red.read() != 0;
+        }
+        void paint(Node* node, bool red) const {
+            if (node)
+                at(node).red = red ? 1 : 0;
+        }
+    private:
+        /** Replace a child of a node's parent (or the root).
+         * @param node  Node being replaced
+         * @param other Replacing node
+        **/
+        void relink(Node* node, Node* other) const {
+            auto up = parent(node);
+            if (other)
+                at(other).parent = up;
+            if (!up) {
+                root = other;
+            } else if (left(up) == node) {
+                at(up).left = other;
+            } else {
+                at(up).right = other;
+            }
+        }
+        void rotate_left(Node* node) const {
+            if (!node)
+                return;
+            auto pivot = right(node);
+            auto inner = left(pivot);
+            at(node).right = inner;
+            if (inner)
+                at(inner).parent = node;
+            relink(node, pivot);
+            at(pivot).left = node;
+            at(node).parent = pivot;
+        }
+        void rotate_right(Node* node) const {
+            if (!node)
+                return;
+            auto pivot = left(node);
+            auto inner = right(pivot);
+            at(node).left = inner;
+            if (inner)
+                at(inner).parent = node;
+            relink(node, pivot);
+            at(pivot).right = node;
+            at(node).parent = pivot;
+        }
+        void fix_insert(Node* node) const {
+            while (node && node != get_root() && is_red(parent(node))) {
+                auto up = parent(node);
+                auto grand = parent(up);
+                if (up == left(grand)) {
+                    auto uncle = right(grand);
+                    if (is_red(uncle)) {
+                        paint(up, false);
+                        paint(uncle, false);
+                        paint(grand, true);
+                        node = grand;
+                    } else {
+                        if (node == right(up)) {
+                            node = up;
+                            rotate_left(node);
+                        }
+                        paint(parent(node), false);
+                        paint(parent(parent(node)), true);
+                        rotate_right(parent(parent(node)));
+                    }
+                } else {
+                    auto uncle = left(grand);
+                    if (is_red(uncle)) {
+                        paint(up, false);
+                        paint(uncle, false);
+                        paint(grand, true);
+                        node = grand;
+                    } else {
+                        if (node == left(up)) {
+                            node = up;
+                            rotate_right(node);
+                        }
+                        paint(parent(node), false);
+                        paint(parent(parent(node)), true);
+                        rotate_left(parent(parent(node)));
+                    }
+                }
+            }
+            paint(get_root(), false);
+        }
+        void fix_remove(Node* node) const {
+            while (node != get_root() && !is_red(node)) {
+                if (node == left(parent(node))) {
+                    auto sibling = right(parent(node));
+                    if (is_red(sibling)) {
+                        paint(sibling, false);
+                        paint(parent(node), true);
+                        rotate_left(parent(node));
+                        sibling = right(parent(node));
+                    }
+                    if (!is_red(left(sibling)) && !is_red(right(sibling))) {
+                        paint(sibling, true);
+                        node = parent(node);
+                    } else {
+                        if (!is_red(right(sibling))) {
+                            paint(left(sibling), false);
+                            paint(sibling, true);
+                            rotate_right(sibling);
+                            sibling = right(parent(node));
+                        }
+                        paint(sibling, is_red(parent(node)));
+                        paint(parent(node), false);
+                        paint(right(sibling), false);
+                        rotate_left(parent(node));
+                        node = get_root();
+                    }
+                } else {
+                    auto sibling = left(parent(node));
+                    if (is_red(sibling)) {
+                        paint(sibling, false);
+                        paint(parent(node), true);
+                        rotate_right(parent(node));
+                        sibling = left(parent(node));
+                    }
+                    if (!is_red(right(sibling)) && !is_red(left(sibling))) {
+                        paint(sibling, true);
+                        node = parent(node);
+                    } else {
+                        if (!is_red(left(sibling))) {
+                            paint(right(sibling), false);
+                            paint(sibling, true);
+                            rotate_left(sibling);
+                            sibling = left(parent(node));
+                        }
+                        paint(sibling, is_red(parent(node)));
+                        paint(parent(node), false);
+                        paint(left(sibling), false);
+                        rotate_right(parent(node));
+                        node = get_root();
+                    }
+                }
+            }
+            paint(node, false);
+        }
+    public:
+        /** Find the node holding a key.
+         * @param key Key to look for
+         * @return Node holding the key, 'nullptr' if none
+        **/
+        Node* find(Key key) const {
+            Node* curr = root;
+            while (curr) {
+                Key other = at(curr).key;
+                if (key == other)
+                    break;
+                curr = key < other ? left(curr) : right(curr);
+            }
+            return curr;
+        }
+        /** Insert a key.
+         * @param key Key to insert
+         * @return Whether the key was absent
+        **/
+        bool insert(Key key) const {
+            Node* up = nullptr;
+            Node* curr = root;
+            while (curr) {
+                Key other = at(curr).key;
+                if (key == other)
+                    return false;
+                up = curr;
+                curr = key < other ? left(curr) : right(curr);
+            }
+            auto node = reinterpret_cast<Node*>(tx.alloc(Node::size()));
+            {
+                auto&& bound = at(node);
+                bound.key = key;
+                bound.value = ~key;
+                bound.red = 1;
+                bound.left = nullptr;
+                bound.right = nullptr;
+                bound.parent = up;
+            }
+            if (!up) {
+                root = node;
+            } else if (key < at(up).key) {
+                at(up).left = node;
+            } else {
+                at(up).right = node;
+            }
+            fix_insert(node);
+            return true;
+        }
+        /** Remove a key.
+         * @param key Key to remove
+         * @return Whether the key was present
+        **/
+        bool remove(Key key) const {
+            auto node = find(key);
+            if (!node)
+                return false;
+            if (left(node) && right(node)) { // Move the successor's content here, then remove the successor
+                auto next = right(node);
+                while (left(next))
+                    next = left(next);
+                at(node).key = at(next).key.read();
+                at(node).value = at(next).value.read();
+                node = next;
+            }
+            auto child = left(node) ? left(node) : right(node);
+            if (child) {
+                relink(node, child);
+                if (!is_red(node))
+                    fix_remove(child);
+            } else if (!parent(node)) {
+                root = nullptr;
+            } else {
+                if (!is_red(node)) // The node stands for its null leaf during the fix-up
+                    fix_remove(node);
+                auto up = parent(node);
+                if (up) {
+                    if (left(up) == node) {
+                        at(up).left = nullptr;
+                    } else if (right(up) == node) {
+                        at(up).right = nullptr;
+                    }
+                }
+            }
+            tx.free(node);
+            return true;
+        }
+    };
+public:
+    /** Red-black tree workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbkeys      Number of distinct keys
+     * @param prob_update Probability of running an insertion/removal transaction instead of a lookup
+    **/
+    WorkloadTree(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, float prob_update): WorkloadSet{library, Node::align(), sizeof(Node*), nbworkers, nbtxperwrk, nbkeys, prob_update} {}
+private:
+    /** Check a subtree.
+     * @param tree   Tree in the pending transaction
+     * @param node   Subtree root
+     * @param parent Expected parent of the subtree root
+     * @param low    Smallest allowed key
+     * @param high   Smallest disallowed key
+     * @return Black height of the subtree, negative on inconsistency
+    **/
+    long subtree(Tree const& tree, Node* node, Node* parent, Key low, Key high) const {
+        if (!node)
+            return 1;
+        Key key = tree.at(node).key;
+        if (unlikely(key < low || key >= high || tree.parent(node) != parent || tree.at(node).value != ~key))
+            return -1;
+        auto red = tree.is_red(node);
+        auto left = tree.left(node);
+        auto right = tree.right(node);
+        if (unlikely(red && (tree.is_red(left) || tree.is_red(right)))) // No red node has a red child
+            return -1;
+        auto height = subtree(tree, left, node, low, key);
+        if (unlikely(height < 0 || height != subtree(tree, right, node, key + 1, high))) // Same number of black nodes on every path
+            return -1;
+        return red ? height : height + 1;
+    }
+protected:
+    virtual bool insert(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            return Tree{tx, tm.get_start()}.insert(key);
+        });
+    }
+    virtual bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            return Tree{tx, tm.get_start()}.remove(key);
+        });
+    }
+    virtual bool contains(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return Tree{tx, tm.get_start()}.find(key) != nullptr;
+        });
+    }
+    virtual bool verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Tree tree{tx, tm.get_start()};
+            auto root = tree.get_root();
+            return !tree.is_red(root) && subtree(tree, root, nullptr, 0, nbkeys) >= 0;
+        });
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** Vacation-style reservation system workload class.
+**/
+class WorkloadVacation final: public Workload {
+private:
+    constexpr static size_t nbtypes   = 3;   // Number of resource tables (cars, flights, rooms)
+    constexpr static size_t nbqueries = 4;   // Number of resources queried per transaction
+    constexpr static size_t capacity  = 100; // Initial capacity of every resource
+    /** Shared reservation class, in the list of a customer.
+    **/
+    class Reservation final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            size_t dummy0;
+            size_t dummy1;
+            size_t dummy2;
+            void*  dummy3;
+        };
+    public:
+        /** Get the reservation size.
+         * @return Reservation size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+    public:
+        Shared<size_t>       type;  // Reserved resource table
+        Shared<size_t>       id;    // Reserved resource in the table
+        Shared<size_t>       price; // Price at reservation time
+        Shared<Reservation*> next;  // Next reservation of the same customer
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Reservation(Reservation const&) = delete;
+        Reservation& operator=(Reservation const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Reservation(Transaction& tx, void* address): type{tx, address}, id{tx, type.after()}, price{tx, id.after()}, next{tx, price.after()} {}
+    };
+    /** Shared resource class, in a resource table.
+    **/
+    class Resource final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            size_t dummy0;
+            size_t dummy1;
+            size_t dummy2;
+        };
+    public:
+        /** Get the resource size.
+         * @return Resource size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the resource alignment.
+         * @return Resource alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<size_t> total; // Capacity
+        Shared<size_t> used;  // Number of reservations (at most the capacity)
+        Shared<size_t> price; // Current price
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Resource(Resource const&) = delete;
+        Resource& operator=(Resource const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Resource(Transaction& tx, void* address): total{tx, address}, used{tx, total.after()}, price{tx, used.after()} {}
+    };
+    /** Shared customer class.
+    **/
+    class Customer final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            void*  dummy0;
+            size_t dummy1;
+        };
+    public:
+        /** Get the customer size.
+         * @return Customer size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+    public:
+        Shared<Reservation*> list; // Reservations of the customer
+        Shared<size_t>       bill; // Sum of the prices of the reservations
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Customer(Customer const&) = delete;
+        Customer& operator=(Customer const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Customer(Transaction& tx, void* address): list{tx, address}, bill{tx, list.after()} {}
+    };
+    /** Transaction types, for the transaction statistics.
+    **/
+    enum TxType: size_t {
+        TxReserve,
+        TxDelete,
+        TxUpdate,
+        TxVerify
+    };
+    /** Resource query, prepared outside of the transaction so that retries run the same one.
+    **/
+    struct Query {
+        size_t type; // Resource table
+        size_t id;   // Resource in the table
+        size_t arg;  // Operation-specific argument
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  nbrelations; // Number of resources per table, and number of customers
+    float   prob_update; // Probability of running a customer deletion or table update instead of a reservation
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Vacation workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbrelations Number of resources per table, and number of customers
+     * @param prob_update Probability of running a customer deletion or table update instead of a reservation
+    **/
+    WorkloadVacation(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbrelations, float prob_update): Workload{library, Resource::align(), nbrelations * (nbtypes * Resource::size() + Customer::size())}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbrelations{nbrelations}, prob_update{prob_update}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+private:
+    /** Get the address of a resource.
+     * @param type Resource table
+     * @param id   Resource in the table
+     * @return Resource address
+    **/
+    void* resource(size_t type, size_t id) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + (type * nbrelations + id) * Resource::size();
+    }
+    /** Get the address of a customer.
+     * @param id Customer ID
+     * @return Customer address
+    **/
+    void* customer(size_t id) const noexcept {
+        return reinterpret_cast<char*>(tm.get_start()) + nbtypes * nbrelations * Resource::size() + id * Customer::size();
+    }
+    /** Draw random queries.
+     * @param engine Randomness source
+     * @return Queries, with a random argument
+    **/
+    template<class Engine> ::std::vector<Query> draw(Engine& engine) const {
+        ::std::uniform_int_distribution<size_t> type_dist{0, nbtypes - 1};
+        ::std::uniform_int_distribution<size_t> id_dist{0, nbrelations - 1};
+        ::std::uniform_int_distribution<size_t> arg_dist{0, 99};
+        ::std::vector<Query> res(nbqueries);
+        for (auto&& query: res)
+            query = Query{type_dist(engine), id_dist(engine), arg_dist(engine)};
+        return res;
+    }
+    /** Reservation transaction, reserving the most expensive available resource of each queried table for a customer.
+     * @param cust    Customer ID
+     * @param queries Queried resources
+    **/
+    void reserve_tx(size_t cust, ::std::vector<Query> const& queries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            size_t best[nbtypes];
+            size_t best_price[nbtypes];
+            for (size_t type = 0; type < nbtypes; ++type)
+                best[type] = nbrelations; // None yet
+            for (auto&& query: queries) {
+                Resource res{tx, resource(query.type, query.id)};
+                if (res.used.read() >= res.total.read())
+                    continue;
+                size_t price = res.price;
+                if (best[query.type] == nbrelations || price > best_price[query.type]) {
+                    best[query.type] = query.id;
+                    best_price[query.type] = price;
+                }
+            }
+            Customer cus{tx, customer(cust)};
+            for (size_t type = 0; type < nbtypes; ++type) {
+                if (best[type] == nbrelations)
+                    continue;
+                Resource res{tx, resource(type, best[type])};
+                res.used = res.used.read() + 1;
+                auto addr = tx.alloc(Reservation::size());
+                Reservation rsv{tx, addr};
+                rsv.type = type;
+                rsv.id = best[type];
+                rsv.price = best_price[type];
+                rsv.next = cus.list.read();
+                cus.list = reinterpret_cast<Reservation*>(addr);
+                cus.bill = cus.bill.read() + best_price[type];
+            }
+        });
+    }
+    /** Customer deletion transaction, cancelling all of its reservations.
+     * @param cust Customer ID
+    **/
+    void delete_tx(size_t cust) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Customer cus{tx, customer(cust)};
+            Reservation* curr = cus.list;
+            while (curr) {
+                Reservation rsv{tx, curr};
+                Resource res{tx, resource(rsv.type, rsv.id)};
+                res.used = res.used.read() - 1;
+                Reservation* next = rsv.next;
+                tx.free(curr);
+                curr = next;
+            }
+            cus.list = nullptr;
+            cus.bill = 0;
+        });
+    }
+    /** Table update transaction, adding capacity (and changing the price) or removing unused capacity.
+     * @param queries Updated resources, with an even argument to add capacity
+    **/
+    void update_tx(::std::vector<Query> const& queries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (auto&& query: queries) {
+                Resource res{tx, resource(query.type, query.id)};
+                size_t total = res.total;
+                if (query.arg % 2 == 0) {
+                    res.total = total + 1;
+                    res.price = 50 + query.arg;
+                } else if (res.used.read() < total) {
+                    res.total = total - 1;
+                }
+            }
+        });
+    }
+    /** Read-only transaction checking that the resources and the customers agree.
+     * @return Whether no inconsistency has been found
+    **/
+    bool verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            ::std::vector<size_t> used(nbtypes * nbrelations, 0);
+            for (size_t cust = 0; cust < nbrelations; ++cust) {
+                Customer cus{tx, customer(cust)};
+                size_t bill = 0;
+                for (Reservation* curr = cus.list; curr;) {
+                    Reservation rsv{tx, curr};
+                    size_t type = rsv.type;
+                    size_t id = rsv.id;
+                    if (unlikely(type >= nbtypes || id >= nbrelations))
+                        return false;
+                    ++used[type * nbrelations + id];
+                    bill += rsv.price;
+                    curr = rsv.next;
+                }
+                if (unlikely(bill != cus.bill)) // The bill matches the reservations
+                    return false;
+            }
+            for (size_t type = 0; type < nbtypes; ++type) {
+                for (size_t id = 0; id < nbrelations; ++id) {
+                    Resource res{tx, resource(type, id)};
+                    size_t count = res.used;
+                    if (unlikely(count != used[type * nbrelations + id] || count > res.total)) // Reservations are accounted for, within capacity
+                        return false;
+                }
+            }
+            return true;
+        });
+    }
+    /** Run one random transaction.
+     * @param engine Randomness source
+    **/
+    template<class Engine> void random_tx(Engine& engine) const {
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution delete_dist{0.5};
+        ::std::uniform_int_distribution<size_t> cust_dist{0, nbrelations - 1};
+        if (update_dist(engine)) {
+            if (delete_dist(engine)) {
+                TxRecorder::set_type(TxDelete);
+                delete_tx(cust_dist(engine));
+            } else {
+                TxRecorder::set_type(TxUpdate);
+                update_tx(draw(engine));
+            }
+        } else {
+            TxRecorder::set_type(TxReserve);
+            auto cust = cust_dist(engine);
+            reserve_tx(cust, draw(engine));
+        }
+    }
+public:
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"reserve", "delete", "update", "verify"};
+    }
+    /**
+     * Fill the resource tables and the customers (idempotent, every worker runs it) and check them.
+    **/
+    virtual char const* init() const {
+        for (size_t id = 0; id < nbrelations; ++id) {
+            transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                for (size_t type = 0; type < nbtypes; ++type) {
+                    Resource res{tx, resource(type, id)};
+                    res.total = capacity;
+                    res.used = 0;
+                    res.price = 50 + (id * 7 + type * 13) % 50;
+                }
+                Customer cus{tx, customer(id)};
+                cus.list = nullptr;
+                cus.bill = 0;
+            });
+        }
+        if (unlikely(!verify()))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run nbtxperwrk (or until the deadline) random reservations, customer deletions and table updates, then check the system.
+     * @param uid  Worker unique ID
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        for (size_t cntr = 0; next(uid, cntr, nbtxperwrk); ++cntr)
+            random_tx(engine);
+        TxRecorder::set_type(TxVerify);
+        if (unlikely(!verify()))
+            return "Violated isolation or atomicity";
+        return nullptr;
+    }
+    /**
+     * Test in which all threads run random transactions concurrently, after which the first thread checks the system.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbtxperwrk = 100;
+
+        ::std::minstd_rand engine{seed};
+        barrier.sync();
+        for (size_t i = 0; i < nbtxperwrk; ++i)
+            random_tx(engine);
+        barrier.sync();
+        if (uid == 0 && unlikely(!verify()))
+            return "Violated consistency, isolation or atomicity";
+        return nullptr;
+    }
+};
+
+// -------------------------------------------------------------------------- //
+
+/** K-means-style workload class: each worker assigns its (private) points to the nearest center, and accumulates them in the shared clusters.
+**/
+class WorkloadKmeans final: public Workload {
+public:
+    /** Coordinate class alias.
+    **/
+    using Coord = intptr_t;
+private:
+    constexpr static size_t nbclusters   = 16;   // Number of clusters
+    constexpr static size_t nbdims       = 4;    // Number of dimensions
+    constexpr static size_t nbiterations = 4;    // Number of iterations per run
+    constexpr static Coord  range        = 1024; // Points are in [0, range)^nbdims
+    /** Transaction types, for the transaction statistics.
+    **/
+    enum TxType: size_t {
+        TxRead,
+        TxAdd,
+        TxRecenter
+    };
+    /** Get the size of the first shared segment: the centers, then the cluster sizes, then the cluster sums.
+     * @return Segment size (in bytes)
+    **/
+    constexpr static size_t size() noexcept {
+        return (2 * nbclusters * nbdims + nbclusters) * sizeof(Coord);
+    }
+private:
+    size_t  nbworkers; // Number of concurrent workers
+    size_t  nbpoints;  // Number of points per worker
+    ::std::vector<Coord> points; // Coordinates of the points of every worker, worker after worker
+    ::std::vector<Coord> sums;   // Sum of the coordinates of all the points, per dimension
+    Barrier barrier;   // Barrier for thread synchronization between iterations
+    ::std::atomic<bool> mutable more; // Whether to run another iteration, decided by the first worker between the barriers
+public:
+    /** K-means workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker (the number of points is derived from it)
+    **/
+    WorkloadKmeans(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk): Workload{library, alignof(Coord), size()}, nbworkers{nbworkers}, nbpoints{nbtxperwrk / nbiterations > 0 ? nbtxperwrk / nbiterations : 1}, points(nbworkers * nbpoints * nbdims), sums(nbdims, 0), barrier{static_cast<Barrier::Counter>(nbworkers)}, more{false} {
+        // Points scattered around hidden centers, the same input for every library
+        ::std::minstd_rand engine{static_cast<Seed>(nbworkers * nbpoints)};
+        ::std::uniform_int_distribution<Coord> center_dist{range / 8, range - range / 8 - 1};
+        ::std::uniform_int_distribution<Coord> noise_dist{-range / 8, range / 8};
+        ::std::uniform_int_distribution<size_t> cluster_dist{0, nbclusters - 1};
+        ::std::vector<Coord> hidden(nbclusters * nbdims);
+        for (auto&& coord: hidden)
+            coord = center_dist(engine);
+        for (size_t i = 0; i < nbworkers * nbpoints; ++i) {
+            auto center = cluster_dist(engine);
+            for (size_t d = 0; d < nbdims; ++d) {
+                auto coord = hidden[center * nbdims + d] + noise_dist(engine);
+                points[i * nbdims + d] = coord;
+                sums[d] += coord;
+            }
+        }
+    }
+private:
+    /** Bind the centers.
+     * @param tx Pending transaction
+     * @return Shared on the centers, cluster after cluster
+    **/
+    Shared<Coord[]> centers(Transaction& tx) const {
+        return Shared<Coord[]>{tx, tm.get_start()};
+    }
+    /** Bind the cluster sizes.
+     * @param tx Pending transaction
+     * @return Shared on the number of points per cluster
+    **/
+    Shared<Coord[]> counts(Transaction& tx) const {
+        return Shared<Coord[]>{tx, centers(tx).after(nbclusters * nbdims)};
+    }
+    /** Bind the cluster sums.
+     * @param tx Pending transaction
+     * @return Shared on the sum of the coordinates per cluster, cluster after cluster
+    **/
+    Shared<Coord[]> totals(Transaction& tx) const {
+        return Shared<Coord[]>{tx, counts(tx).after(nbclusters)};
+    }
+    /** Add a point to a cluster.
+     * @param cluster Cluster to update
+     * @param point   Coordinates of the point
+    **/
+    void add_tx(size_t cluster, Coord const* point) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto count = counts(tx)[cluster];
+            count = count.read() + 1;
+            auto total = totals(tx);
+            for (size_t d = 0; d < nbdims; ++d)
+                total[cluster * nbdims + d] = total[cluster * nbdims + d].read() + point[d];
+        });
+    }
+    /** Move the centers to the mean of their cluster and empty the clusters.
+     * @param expected Expected number of points over all the clusters
+     * @param sums     Expected sum of the coordinates over all the clusters, per dimension
+     * @return Whether the clusters held exactly the expected points
+    **/
+    bool recenter_tx(Coord expected, Coord const* sums) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto center = centers(tx);
+            auto count = counts(tx);
+            auto total = totals(tx);
+            Coord seen = 0;
+            Coord seen_sums[nbdims] = {};
+            for (size_t c = 0; c < nbclusters; ++c) {
+                Coord size = count[c];
+                seen += size;
+                for (size_t d = 0; d < nbdims; ++d) {
+                    Coord sum = total[c * nbdims + d];
+                    seen_sums[d] += sum;
+                    if (size > 0) // An empty cluster keeps its center
+                        center[c * nbdims + d] = sum / size;
+                    total[c * nbdims + d] = 0;
+                }
+                count[c] = 0;
+            }
+            if (seen != expected)
+                return false;
+            for (size_t d = 0; d < nbdims; ++d) {
+                if (seen_sums[d] != sums[d])
+                    return false;
+            }
+            return true;
+        });
+    }
+public:
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"read", "add", "recenter"};
+    }
+    /**
+     * Place the centers on the first points and empty the clusters (idempotent, every worker runs it).
+    **/
+    virtual char const* init() const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto center = centers(tx);
+            auto count = counts(tx);
+            auto total = totals(tx);
+            for (size_t i = 0; i < nbclusters * nbdims; ++i) {
+                center[i] = points[i % points.size()];
+                total[i] = 0;
+            }
+            for (size_t c = 0; c < nbclusters; ++c)
+                count[c] = 0;
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return centers(tx)[0] == points[0];
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    /**
+     * Run the iterations: assign the points of this worker, then the first worker checks the clusters and moves the centers.
+     * When time-bounded, the iterations go on until the deadline, only ever stopping between two iterations.
+     * @param uid Id of the worker (selects its points)
+    **/
+    virtual char const* run(Uid uid, Seed seed [[gnu::unused]]) const {
+        char const* error = nullptr;
+        auto mine = points.data() + uid * nbpoints * nbdims;
+        for (size_t iter = 0; deadline ? iter == 0 || more.load(::std::memory_order_relaxed) : iter < nbiterations; ++iter) {
+            Coord local[nbclusters * nbdims];
+            TxRecorder::set_type(TxRead);
+            transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                auto center = centers(tx);
+                for (size_t i = 0; i < nbclusters * nbdims; ++i)
+                    local[i] = center[i];
+            });
+            TxRecorder::set_type(TxAdd);
+            for (size_t p = 0; p < nbpoints; ++p) {
+                auto point = mine + p * nbdims;
+                size_t nearest = 0;
+                Coord best = ::std::numeric_limits<Coord>::max();
+                for (size_t c = 0; c < nbclusters; ++c) {
+                    Coord dist = 0;
+                    for (size_t d = 0; d < nbdims; ++d) {
+                        auto delta = point[d] - local[c * nbdims + d];
+                        dist += delta * delta;
+                    }
+                    if (dist < best) {
+                        best = dist;
+                        nearest = c;
+                    }
+                }
+                add_tx(nearest, point);
+                if (deadline) // The iteration always completes, the deadline only counts
+                    deadline->count(uid);
+            }
+            barrier.sync();
+            if (uid == 0) {
+                TxRecorder::set_type(TxRecenter);
+                if (!recenter_tx(static_cast<Coord>(nbworkers * nbpoints), sums.data()) && !error)
+                    error = "Violated isolation or atomicity";
+                more.store(deadline && !deadline->is_expired(), ::std::memory_order_relaxed);
+            }
+            barrier.sync();
+        }
+        return error;
+    }
+    /**
+     * Test in which all threads add known values to random clusters concurrently, after which the first thread checks the sums.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbtxperwrk = 100;
+
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> cluster_dist{0, nbclusters - 1};
+        Coord point[nbdims];
+        for (size_t d = 0; d < nbdims; ++d)
+            point[d] = static_cast<Coord>(uid + 1);
+        barrier.sync();
+        for (size_t i = 0; i < nbtxperwrk; ++i)
+            add_tx(cluster_dist(engine), point);
+        barrier.sync();
+        if (uid == 0) {
+            auto expected = static_cast<Coord>(nbtxperwrk * nbworkers);
+            Coord expected_sums[nbdims];
+            for (size_t d = 0; d < nbdims; ++d)
+                expected_sums[d] = static_cast<Coord>(nbtxperwrk * nbworkers * (nbworkers + 1) / 2);
+            if (unlikely(!recenter_tx(expected, expected_sums)))
+                return "Violated consistency, isolation or atomicity";
+        }
+        return nullptr;
+    }
+};
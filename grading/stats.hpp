@@ -0,0 +1,246 @@
+/**
+ * @file   stats.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Per-thread transaction statistics: attempts, commits, retries and latencies, per transaction type.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Log-linear histogram (HDR-style): exact below 128, then 64 buckets per power of two (under 1.6% error).
+**/
+class Histogram final {
+public:
+    /** Value class alias.
+    **/
+    using Value = Chrono::Tick;
+private:
+    constexpr static unsigned int sub_bits = 7;               // log2 of the number of exact values
+    constexpr static Value        sub      = 1 << sub_bits;   // Number of exact values
+    constexpr static Value        half     = sub / 2;         // Number of buckets per power of two, above the exact values
+    constexpr static size_t       nbbuckets = sub + (64 - sub_bits) * half; // Enough for any 64-bit value
+private:
+    ::std::vector<uint_fast64_t> buckets; // Number of values per bucket
+    uint_fast64_t count; // Number of values
+    Value max;           // Largest value
+private:
+    /** Get the bucket of a value.
+     * @param value Value to place
+     * @return Bucket index
+    **/
+    static size_t index(Value value) noexcept {
+        if (value < sub)
+            return static_cast<size_t>(value);
+        auto group = static_cast<unsigned int>(63 - __builtin_clzll(value)) - sub_bits + 1; // Bucket width is 2^group
+        return static_cast<size_t>(sub + (group - 1) * half + ((value >> group) - half));
+    }
+    /** Get the value a bucket stands for.
+     * @param index Bucket index
+     * @return Middle of the bucket
+    **/
+    static Value middle(size_t index) noexcept {
+        if (index < sub)
+            return static_cast<Value>(index);
+        auto group = static_cast<unsigned int>((index - sub) / half) + 1;
+        auto low = (static_cast<Value>((index - sub) % half) + half) << group;
+        return low + (Value{1} << group) / 2;
+    }
+public:
+    /** Empty histogram constructor.
+    **/
+    Histogram(): buckets(nbbuckets, 0), count{0}, max{0} {}
+public:
+    /** Record a value.
+     * @param value Value to record
+    **/
+    void record(Value value) noexcept {
+        ++buckets[index(value)];
+        ++count;
+        if (value > max)
+            max = value;
+    }
+    /** Add all the values of another histogram.
+     * @param other Histogram to merge in
+    **/
+    void merge(Histogram const& other) noexcept {
+        for (size_t i = 0; i < nbbuckets; ++i)
+            buckets[i] += other.buckets[i];
+        count += other.count;
+        if (other.max > max)
+            max = other.max;
+    }
+    /** Forget every recorded value, keeping the buckets allocated.
+    **/
+    void clear() noexcept {
+        ::std::fill(buckets.begin(), buckets.end(), 0);
+        count = 0;
+        max = 0;
+    }
+    /** Get the number of recorded values.
+     * @return Number of values
+    **/
+    auto get_count() const noexcept {
+        return count;
+    }
+    /** Get the largest recorded value.
+     * @return Largest value (0 if empty)
+    **/
+    auto get_max() const noexcept {
+        return max;
+    }
+    /** Get a percentile.
+     * @param percent Percentile to get, in [0, 100]
+     * @return Value below which 'percent' % of the values are (0 if empty)
+    **/
+    Value get_percentile(double percent) const noexcept {
+        auto target = static_cast<uint_fast64_t>(percent / 100. * static_cast<double>(count) + 0.5);
+        if (target == 0)
+            target = 1;
+        uint_fast64_t seen = 0;
+        for (size_t i = 0; i < nbbuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= target)
+                return middle(i) < max ? middle(i) : max;
+        }
+        return max;
+    }
+};
+
+/** Statistics of one transaction type.
+**/
+class TxStats final {
+public:
+    uint_fast64_t attempts; // Number of attempts (commits and retries)
+    uint_fast64_t commits;  // Number of committed transactions
+    Histogram     retries;  // Number of retries before each commit
+    Histogram     latency;  // Time from the first attempt to the commit (only if timed)
+public:
+    /** Empty statistics constructor.
+    **/
+    TxStats(): attempts{0}, commits{0} {}
+public:
+    /** Add the statistics of another thread.
+     * @param other Statistics to merge in
+    **/
+    void merge(TxStats const& other) noexcept {
+        attempts += other.attempts;
+        commits += other.commits;
+        retries.merge(other.retries);
+        latency.merge(other.latency);
+    }
+    /** Get the fraction of the attempts that did not commit.
+     * @return Abort rate, in [0, 1]
+    **/
+    double get_abort_rate() const noexcept {
+        if (attempts == 0)
+            return 0.;
+        return static_cast<double>(attempts - commits) / static_cast<double>(attempts);
+    }
+};
+
+/** Transaction statistics recorder of one thread, one 'TxStats' per transaction type of the workload.
+**/
+class TxRecorder final {
+private:
+    static thread_local TxRecorder* local; // Recorder of the current thread, 'nullptr' for none
+    ::std::vector<TxStats> stats; // One entry per transaction type
+    size_t current; // Type of the next transactions
+    bool   timed;   // Whether to time the transactions
+public:
+    /** Transaction types constructor.
+     * @param nbtypes Number of transaction types
+     * @param timed   Whether to time the transactions
+    **/
+    TxRecorder(size_t nbtypes = 1, bool timed = false): stats(nbtypes > 0 ? nbtypes : 1), current{0}, timed{timed} {}
+public:
+    /** Install a recorder on the current thread.
+     * @param recorder Recorder to use, 'nullptr' to stop recording
+    **/
+    static void install(TxRecorder* recorder) noexcept {
+        local = recorder;
+    }
+    /** Get the recorder of the current thread.
+     * @return Recorder of the current thread, 'nullptr' if not recording
+    **/
+    static TxRecorder* get_local() noexcept {
+        return local;
+    }
+    /** Set the type of the next transactions of the current thread (no-op when not recording).
+     * @param type Transaction type index
+    **/
+    static void set_type(size_t type) noexcept {
+        if (local && type < local->stats.size())
+            local->current = type;
+    }
+public:
+    /** Tell whether the transactions are timed.
+     * @return Whether to time the transactions
+    **/
+    bool is_timed() const noexcept {
+        return timed;
+    }
+    /** Record a committed transaction of the current type.
+     * @param attempts Number of attempts, the committed one included
+     * @param latency  Time from the first attempt to the commit (in ns), ignored if not timed
+    **/
+    void record(uint_fast64_t attempts, Histogram::Value latency) noexcept {
+        auto& entry = stats[current];
+        entry.attempts += attempts;
+        ++entry.commits;
+        entry.retries.record(attempts - 1);
+        if (timed)
+            entry.latency.record(latency);
+    }
+    /** Access the statistics.
+     * @return Statistics, one entry per transaction type
+    **/
+    auto const& get_stats() const noexcept {
+        return stats;
+    }
+};
+inline thread_local TxRecorder* TxRecorder::local = nullptr;
+
+/** Transaction probe, counting the attempts of one transaction and timing it if the current thread records statistics.
+**/
+class TxProbe final: private NonCopyable {
+private:
+    TxRecorder*   recorder; // Recorder of the current thread, 'nullptr' for none
+    uint_fast64_t attempts; // Number of attempts so far
+    Chrono        chrono;   // Time since the first attempt
+public:
+    /** Start constructor.
+    **/
+    TxProbe() noexcept: recorder{TxRecorder::get_local()}, attempts{0} {
+        if (recorder && recorder->is_timed())
+            chrono.start();
+    }
+    /** Record destructor, the transaction committed unless an exception is unwinding.
+    **/
+    ~TxProbe() {
+        if (recorder && likely(::std::uncaught_exceptions() == 0))
+            recorder->record(attempts, recorder->is_timed() ? chrono.delta() : 0);
+    }
+public:
+    /** Count one more attempt.
+    **/
+    void attempt() noexcept {
+        ++attempts;
+    }
+};
@@ -32,8 +32,10 @@ extern "C" {
 // Internal headers
 namespace STM {
 #include <tm.hpp>
+#include <tm-ext.hpp>
 }
 #include "common.hpp"
+#include "stats.hpp"
 
 // -------------------------------------------------------------------------- //
 namespace Exception {
@@ -80,6 +82,8 @@ private:
     using FnWrite   = decltype(&STM::tm_write);
     using FnAlloc   = decltype(&STM::tm_alloc);
     using FnFree    = decltype(&STM::tm_free);
+    using FnStats   = decltype(&STM::tm_stats);
+    using FnScan    = decltype(&STM::tm_scan);
 private:
     void*     module;     // Module opaque handler
     FnCreate  tm_create;  // Module's initialization function
@@ -93,6 +97,8 @@ private:
     FnWrite   tm_write;   // Module's shared memory write function
     FnAlloc   tm_alloc;   // Module's shared memory allocation function
     FnFree    tm_free;    // Module's shared memory freeing function
+    FnStats   tm_stats;   // Module's statistics function (optional extension, 'nullptr' if not exported)
+    FnScan    tm_scan;    // Module's snapshot scan function (optional extension, 'nullptr' if not exported)
 private:
     /** Solve a symbol from its name, and bind it to the given function.
      * @param name Name of the symbol to resolve
@@ -107,6 +113,14 @@ private:
     template<class Signature> void solve(char const* name, Signature& func) const {
         func = solve<Signature>(name);
     }
+    /** Solve an optional symbol from its name, and bind it to the given function.
+     * @param name Name of the symbol to resolve
+     * @param func Target function to bind, 'nullptr' if the symbol is not exported
+    **/
+    template<class Signature> void solve_optional(char const* name, Signature& func) const {
+        auto res = ::dlsym(module, name);
+        func = res ? *reinterpret_cast<Signature*>(&res) : nullptr;
+    }
 public:
     /** Loader constructor.
      * @param path  Path to the library to load
@@ -132,6 +146,8 @@ public:
             solve("tm_write", tm_write);
             solve("tm_alloc", tm_alloc);
             solve("tm_free", tm_free);
+            solve_optional("tm_stats", tm_stats);
+            solve_optional("tm_scan", tm_scan);
         }
     }
     /** Unloader destructor.
@@ -139,6 +155,18 @@ public:
     ~TransactionalLibrary() noexcept {
         ::dlclose(module); // Close loaded module
     }
+public:
+    /** [thread-safe] Get the library-wide transaction counters, if the library exports 'tm_stats'.
+     * @param counters Counters to fill (zeroed first, so fields the library does not know about stay null)
+     * @return Whether the library exports the counters
+    **/
+    bool get_counters(STM::tm_counters& counters) const noexcept {
+        counters = STM::tm_counters{};
+        if (!tm_stats)
+            return false;
+        tm_stats(&counters);
+        return true;
+    }
 };
 
 /** One shared memory region management class.
@@ -172,7 +200,8 @@ public:
     TransactionalMemory(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, start_size{size}, alignment{align} {
         if (unlikely(assert_mode && (!is_power_of_two(align) || size % align != 0)))
             throw Exception::TransactionAlign{};
-        bounded_run(max_side_time, [&]() {
+        auto const bound = max_side_time + ::std::chrono::milliseconds{size >> 20}; // Plus 1 ms per MiB to zero, for large regions
+        bounded_run(bound, [&]() {
             shared = tl.tm_create(size, align);
             if (unlikely(shared == STM::invalid_shared))
                 throw Exception::TransactionCreate{};
@@ -230,6 +259,16 @@ public:
     auto read(TX tx, void const* source, size_t size, void* target) const noexcept {
         return tl.tm_read(shared, tx, source, size, target);
     }
+    /** [thread-safe] Snapshot scan operation in the given transaction, same as a read but copied in large validated chunks, if the library exports 'tm_scan'.
+     * @param tx     Transaction to use
+     * @param source Source start address
+     * @param size   Source/target range
+     * @param target Target start address
+     * @return Whether the whole transaction can continue
+    **/
+    auto scan(TX tx, void const* source, size_t size, void* target) const noexcept {
+        return tl.tm_scan ? tl.tm_scan(shared, tx, source, size, target) : tl.tm_read(shared, tx, source, size, target);
+    }
     /** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
      * @param tx     Transaction to use
      * @param source Source start address
@@ -314,6 +353,17 @@ public:
             throw Exception::TransactionRetry{};
         }
     }
+    /** [thread-safe] Snapshot scan operation in the bound transaction, source in the shared region and target in a private region.
+     * @param source Source start address
+     * @param size   Source/target range
+     * @param target Target start address
+    **/
+    void scan(void const* source, size_t size, void* target) {
+        if (unlikely(!tm.scan(tx, source, size, target))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
     /** [thread-safe] Write operation in the bound transaction, source in a private region and target in the shared region.
      * @param source Source start address
      * @param size   Source/target range
@@ -521,7 +571,16 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(size_t index, Type const& source) const {
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
+    }
+    /** Snapshot scan operation, reading consecutive cells at once.
+     * @param index  Index of the first cell to read
+     * @param count  Number of cells to read
+     * @param target Private array receiving the cells
+    **/
+    void scan(size_t index, size_t count, Type* target) const {
+        if (count > 0)
+            tx.scan(address + index, count * sizeof(Type), target);
     }
 public:
     /** Reference a cell.
@@ -580,7 +639,7 @@ public:
     void write(size_t index, Type const& source) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -602,14 +661,16 @@ public:
 
 // -------------------------------------------------------------------------- //
 
-/** Repeat a given transaction until it commits.
+/** Repeat a given transaction until it commits, counting its attempts and timing it (retries included) if the current thread records statistics.
  * @param tm   Transactional memory
  * @param mode Transactional mode
  * @param func Transaction closure (Transaction& -> ...)
  * @return Returned value (or void) when the transaction committed
 **/
 template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
+    TxProbe probe; // Records once the committed attempt is destroyed
     do {
+        probe.attempt();
         try {
             Transaction tx{tm, mode};
             return func(tx);
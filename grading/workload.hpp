@@ -24,11 +24,16 @@
 #pragma once
 
 // External headers
+#include <atomic>
+#include <cmath>
 #include <cstdint>
+#include <memory>
 #include <random>
+#include <vector>
 
 // Internal headers
 #include "common.hpp"
+#include "transactional.hpp"
 
 // -------------------------------------------------------------------------- //
 
@@ -40,12 +45,157 @@ using Uid = uint_fast32_t;
 **/
 using Seed = uint_fast32_t;
 
+/** Possibly skewed choice of an index in [0, n), where n may change between two choices.
+**/
+class Skew final {
+public:
+    /** Distribution kind enum class.
+    **/
+    enum class Kind {
+        uniform, // Every index equally likely
+        zipf,    // Index i (from 0) chosen with a probability proportional to 1 / (i + 1)^theta
+        hotset   // The first 'hot_fraction' of the indexes get 'hot_prob' of the choices
+    };
+private:
+    Kind   kind;         // Distribution kind
+    double theta;        // Zipf exponent, in [0, 1)
+    double hot_fraction; // Fraction of the indexes in the hot set, in [0, 1]
+    double hot_prob;     // Probability of choosing in the hot set, in [0, 1]
+    size_t cached;       // Number of indexes the Zipf constants below are for (0 for none)
+    double zetan;        // Sum of 1 / i^theta for i in [1, cached]
+    double eta;          // Zipf constant derived from 'zetan'
+private:
+    /** Update the Zipf constants for another number of indexes, incrementally since the number usually changes by a few.
+     * @param n Non-null number of indexes
+    **/
+    void rezeta(size_t n) {
+        for (; cached < n; ++cached)
+            zetan += ::std::pow(static_cast<double>(cached + 1), -theta);
+        for (; cached > n; --cached)
+            zetan -= ::std::pow(static_cast<double>(cached), -theta);
+        auto zeta2 = 1. + ::std::pow(2., -theta);
+        eta = (1. - ::std::pow(2. / static_cast<double>(n), 1. - theta)) / (1. - zeta2 / zetan);
+    }
+public:
+    /** Uniform distribution constructor.
+    **/
+    Skew(): Skew{Kind::uniform, 0., 0., 0.} {}
+    /** Parameters constructor.
+     * @param kind         Distribution kind
+     * @param theta        Zipf exponent, in [0, 1)
+     * @param hot_fraction Fraction of the indexes in the hot set
+     * @param hot_prob     Probability of choosing in the hot set
+    **/
+    Skew(Kind kind, double theta, double hot_fraction, double hot_prob): kind{kind}, theta{theta}, hot_fraction{hot_fraction}, hot_prob{hot_prob}, cached{0}, zetan{0.}, eta{0.} {}
+public:
+    /** Choose an index (Gray et al.'s method for Zipf, as in YCSB).
+     * @param engine Randomness source
+     * @param n      Non-null number of indexes
+     * @return Chosen index
+    **/
+    template<class Engine> size_t operator()(Engine& engine, size_t n) {
+        switch (kind) {
+        case Kind::zipf: {
+            if (n != cached)
+                rezeta(n);
+            auto u = ::std::uniform_real_distribution<double>{0., 1.}(engine);
+            auto uz = u * zetan;
+            if (uz < 1.)
+                return 0;
+            if (n > 1 && uz < 1. + ::std::pow(.5, theta))
+                return 1;
+            auto res = static_cast<size_t>(static_cast<double>(n) * ::std::pow(eta * u - eta + 1., 1. / (1. - theta)));
+            return res < n ? res : n - 1;
+        }
+        case Kind::hotset: {
+            auto hot = static_cast<size_t>(hot_fraction * static_cast<double>(n));
+            if (hot == 0)
+                hot = 1;
+            if (hot < n && !::std::bernoulli_distribution{hot_prob}(engine)) // Cold set
+                return ::std::uniform_int_distribution<size_t>{hot, n - 1}(engine);
+            return ::std::uniform_int_distribution<size_t>{0, hot - 1}(engine);
+        }
+        default:
+            return ::std::uniform_int_distribution<size_t>{0, n - 1}(engine);
+        }
+    }
+};
+
+/** Time-bounded run control: workers run until the master raises the deadline, counting their transactions.
+**/
+class Deadline final {
+private:
+    /** Per-worker transaction counter, alone on its cache line.
+    **/
+    struct alignas(64) Counter {
+        ::std::atomic<uint_fast64_t> value;
+    };
+private:
+    size_t                       nbworkers; // Number of workers
+    ::std::unique_ptr<Counter[]> counters;  // Transaction counters, one per worker
+    ::std::atomic<bool>          expired;   // Whether the workers must stop
+public:
+    /** Deleted copy constructor/assignment.
+    **/
+    Deadline(Deadline const&) = delete;
+    Deadline& operator=(Deadline const&) = delete;
+    /** Worker count constructor.
+     * @param nbworkers Number of workers
+    **/
+    Deadline(size_t nbworkers): nbworkers{nbworkers}, counters{new Counter[nbworkers]}, expired{false} {
+        reset();
+    }
+public:
+    /** Reset the counters and lower the deadline, before a run.
+    **/
+    void reset() noexcept {
+        for (size_t i = 0; i < nbworkers; ++i)
+            counters[i].value.store(0, ::std::memory_order_relaxed);
+        expired.store(false, ::std::memory_order_relaxed);
+    }
+    /** Raise the deadline.
+    **/
+    void expire() noexcept {
+        expired.store(true, ::std::memory_order_relaxed);
+    }
+    /** [thread-safe] Check whether the deadline is raised.
+     * @return Whether the workers must stop
+    **/
+    bool is_expired() const noexcept {
+        return expired.load(::std::memory_order_relaxed);
+    }
+    /** Count one more transaction for a worker, only called by this worker.
+     * @param uid Worker unique ID
+    **/
+    void count(Uid uid) noexcept {
+        auto& value = counters[uid].value;
+        value.store(value.load(::std::memory_order_relaxed) + 1, ::std::memory_order_relaxed);
+    }
+    /** [thread-safe] Get the number of transactions of a worker.
+     * @param uid Worker unique ID
+     * @return Transaction count
+    **/
+    uint_fast64_t get(Uid uid) const noexcept {
+        return counters[uid].value.load(::std::memory_order_relaxed);
+    }
+    /** [thread-safe] Get the number of transactions of all the workers.
+     * @return Transaction count
+    **/
+    uint_fast64_t get_total() const noexcept {
+        uint_fast64_t res = 0;
+        for (size_t i = 0; i < nbworkers; ++i)
+            res += get(static_cast<Uid>(i));
+        return res;
+    }
+};
+
 /** Workload base class.
 **/
 class Workload {
 protected:
     TransactionalLibrary const& tl;  // Associated transactional library
     TransactionalMemory         tm;  // Built transactional memory to use
+    Deadline*             deadline;  // Time-bounded run control, 'nullptr' to run a fixed number of transactions
 public:
     /** Deleted copy constructor/assignment.
     **/
@@ -56,11 +206,44 @@ public:
      * @param align   Shared memory region required alignment
      * @param size    Size of the shared memory region to allocate
     **/
-    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size} {}
+    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size}, deadline{nullptr} {}
     /** Virtual destructor.
     **/
     virtual ~Workload() {};
 public:
+    /** Get the transactional memory the workload runs on.
+     * @return Built transactional memory
+    **/
+    TransactionalMemory const& get_tm() const noexcept {
+        return tm;
+    }
+    /** Switch between fixed-count and time-bounded runs.
+     * @param control Time-bounded run control, 'nullptr' to run a fixed number of transactions
+    **/
+    void set_deadline(Deadline* control) noexcept {
+        deadline = control;
+    }
+protected:
+    /** [thread-safe] Tell whether a worker runs another transaction, to call before each one.
+     * @param uid   Worker unique ID
+     * @param cntr  Number of transactions already run by the worker in this run
+     * @param count Number of transactions to run, when not time-bounded
+     * @return Whether to run another transaction
+    **/
+    bool next(Uid uid, size_t cntr, size_t count) const noexcept {
+        if (!deadline)
+            return cntr < count;
+        if (cntr > 0)
+            deadline->count(uid);
+        return !deadline->is_expired();
+    }
+public:
+    /** Get the names of the transaction types, in the order of their indexes for 'TxRecorder::set_type'.
+     * @return Transaction type names
+    **/
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"all"};
+    }
     /** Shared memory (re)initialization.
      * @return Constant null-terminated error message, 'nullptr' for none
     **/
@@ -132,6 +315,13 @@ private:
         **/
         AccountSegment(Transaction& tx, void* address): count{tx, address}, next{tx, count.after()}, parity{tx, next.after()}, accounts{tx, parity.after()} {}
     };
+    /** Transaction types, for the transaction statistics.
+    **/
+    enum TxType: size_t {
+        TxShort,
+        TxLong,
+        TxAlloc
+    };
 private:
     size_t  nbworkers;     // Number of concurrent workers
     size_t  nbtxperwrk;    // Number of transactions per worker
@@ -140,6 +330,8 @@ private:
     Balance init_balance;  // Initial account balance
     float   prob_long;     // Probability of running a long, read-only control transaction
     float   prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+    Skew    skew;          // Distribution of the accounts of the short transactions
+    bool    scan;          // Whether the long transactions read each segment of accounts at once
     Barrier barrier;       // Barrier for thread synchronization during 'check'
 public:
     /** Bank workload constructor.
@@ -151,14 +343,17 @@ public:
      * @param init_balance  Initial account balance
      * @param prob_long     Probability of running a long, read-only control transaction
      * @param prob_alloc    Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+     * @param skew          Distribution of the accounts of the short transactions (optional, uniform by default)
+     * @param scan          Whether the long transactions read each segment of accounts at once, with 'tm_scan' if exported, else one 'tm_read' (optional, one account at a time by default)
     **/
-    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc, Skew const& skew = Skew{}, bool scan = false): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, skew{skew}, scan{scan}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
 private:
     /** Long read-only transaction, summing the balance of each account.
      * @param count Loosely-updated number of accounts
      * @return Whether no inconsistency has been found
     **/
     bool long_tx(size_t& nbaccounts) const {
+        ::std::vector<Balance> balances; // Private copy of the accounts of a segment, when scanned
         return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
             auto count = 0ul; // Total number of accounts seen.
             auto sum   = Balance{0}; // Total balance on all seen accounts + parity ammount.
@@ -168,8 +363,12 @@ private:
                 decltype(count) segment_count = segment.count;
                 count += segment_count; // And accumulate the total number of accounts.
                 sum += segment.parity; // We also sum the money that results from the destruction of accounts.
+                if (scan) { // One bulk read of the segment, a snapshot scan if the library supports it
+                    balances.resize(segment_count);
+                    segment.accounts.scan(0, segment_count, balances.data());
+                }
                 for (decltype(count) i = 0; i < segment_count; ++i) {
-                    Balance local = segment.accounts[i];
+                    Balance local = scan ? balances[i] : segment.accounts[i].read();
                     if (unlikely(local < 0)) // If one account has a negative balance, there's a consistency issue.
                         return false;
                     sum += local;
@@ -274,6 +473,9 @@ private:
         });
     }
 public:
+    virtual ::std::vector<char const*> get_tx_types() const {
+        return {"short", "long", "alloc"};
+    }
     /**
      * Initialize the first segment of accounts and check the initial ballance (2 transactions).
     **/
@@ -294,27 +496,32 @@ public:
     }
 
     /**
-     * Run nbtxperwrk random transactions until completion.
+     * Run nbtxperwrk random transactions (or until the deadline) until completion.
+     * @param uid  Worker unique ID
      * @param seed Randomness source
     **/
-    virtual char const* run(Uid uid [[gnu::unused]], Seed seed) const {
+    virtual char const* run(Uid uid, Seed seed) const {
         ::std::minstd_rand engine{seed};
         ::std::bernoulli_distribution long_dist{prob_long};
         ::std::bernoulli_distribution alloc_dist{prob_alloc};
         ::std::gamma_distribution<float> alloc_trigger(expnbaccounts, 1);
+        auto account = skew; // Private copy, as it caches per-count constants
         size_t count = nbaccounts;
-        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+        for (size_t cntr = 0; next(uid, cntr, nbtxperwrk); ++cntr) {
             if (long_dist(engine)) { // We roll a dice and, if "lucky", run a long transaction.
+                TxRecorder::set_type(TxLong);
                 if (unlikely(!long_tx(count))) // If it fails, then we return an error message.
                     return "Violated isolation or atomicity";
             } else if (alloc_dist(engine)) { // Let's roll a dice again to trigger an allocation transaction.
+                TxRecorder::set_type(TxAlloc);
                 alloc_tx(alloc_trigger(engine));
             } else { // No luck with previous rolls, let's just run a short transaction.
-                ::std::uniform_int_distribution<size_t> account{0, count - 1};
-                while (unlikely(!short_tx(account(engine), account(engine))));
+                TxRecorder::set_type(TxShort);
+                while (unlikely(!short_tx(account(engine, count), account(engine, count))));
             }
         }
         { // Last long transaction
+            TxRecorder::set_type(TxLong);
             size_t dummy;
             if (!long_tx(dummy))
                 return "Violated isolation or atomicity";
@@ -0,0 +1,64 @@
+/**
+ * @file   tm-ext.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Optional extensions to the transaction manager interface (C++ version).
+ * None of these symbols are required by the grading tool: a library may export
+ * any subset of them, and callers resolving them at runtime must be ready for
+ * them to be missing.
+**/
+
+#pragma once
+
+#include <tm.hpp>
+
+// -------------------------------------------------------------------------- //
+
+/** One entry of a vectored read or write: same meaning as the arguments of 'tm_read'/'tm_write'.
+**/
+struct tm_vec {
+    void const* source; // Source start address
+    size_t      size;   // Length to copy (in bytes), must be a positive multiple of the alignment
+    void*       target; // Target start address
+};
+
+/** Value of a counter that the library does not keep.
+**/
+constexpr uint64_t tm_uncounted = ~uint64_t(0);
+
+/** Library-wide transaction counters.
+**/
+struct tm_counters {
+    uint64_t commits;         // Number of transactions that committed
+    uint64_t aborts;          // Number of transactions that aborted
+    uint64_t false_conflicts; // Approximate number of aborts on a lock (stripe) last taken for another address than the conflicting one, or 'tm_uncounted'
+};
+
+// -------------------------------------------------------------------------- //
+
+extern "C" {
+    // Thread registration and statistics
+    bool     tm_thread_enter() noexcept;
+    void     tm_thread_exit() noexcept;
+    void     tm_stats(tm_counters*) noexcept;
+    // Elastic transactions and early release
+    tx_t     tm_begin_elastic(shared_t) noexcept;
+    bool     tm_release(shared_t, tx_t, void const*, size_t) noexcept;
+    // Commutative increments
+    bool     tm_add(shared_t, tx_t, void*, intptr_t) noexcept;
+    // Vectored reads and writes
+    bool     tm_readv(shared_t, tx_t, tm_vec const*, size_t) noexcept;
+    bool     tm_writev(shared_t, tx_t, tm_vec const*, size_t) noexcept;
+    // Bulk snapshot reads
+    bool     tm_scan(shared_t, tx_t, void const*, size_t, void*) noexcept;
+    // Single-word operations, outside of any transaction
+    bool     tm_load(shared_t, void const*, void*) noexcept;
+    bool     tm_store(shared_t, void const*, void*) noexcept;
+    bool     tm_cas(shared_t, void*, void*, void const*) noexcept;
+}
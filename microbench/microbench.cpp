@@ -0,0 +1,259 @@
+/**
+ * @file   microbench.cpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Uncontended, single-threaded cost of every 'tm_*' entry point of the given libraries, at several transaction sizes.
+**/
+
+// External headers
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "report.hpp"
+#include "transactional.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Shape of the measured transactions.
+**/
+struct Scenario {
+    char const* name; // Printed name
+    bool   ro;        // Whether the transactions are read-only
+    size_t nbreads;   // Number of 'tm_read' calls
+    size_t rdwords;   // Number of words per 'tm_read' call
+    size_t nbwrites;  // Number of 'tm_write' calls
+    size_t wrwords;   // Number of words per 'tm_write' call
+    bool   alloc;     // Whether to 'tm_alloc' a segment, then 'tm_free' it in the next transaction
+};
+
+/** Measured scenarios, the ones growing a dimension listed together.
+**/
+static Scenario const scenarios[] = {
+    {"ro-empty",      true,  0,  0,   0,  0,   false},
+    {"ro-read-1",     true,  1,  1,   0,  0,   false},
+    {"ro-read-8x1",   true,  8,  1,   0,  0,   false},
+    {"ro-read-64x1",  true,  64, 1,   0,  0,   false},
+    {"ro-read-1x8",   true,  1,  8,   0,  0,   false},
+    {"ro-read-1x64",  true,  1,  64,  0,  0,   false},
+    {"ro-read-1x512", true,  1,  512, 0,  0,   false},
+    {"rw-empty",      false, 0,  0,   0,  0,   false},
+    {"rw-small",      false, 1,  1,   1,  1,   false},
+    {"rw-write-8x1",  false, 0,  0,   8,  1,   false},
+    {"rw-write-1x64", false, 0,  0,   1,  64,  false},
+    {"rw-large",      false, 64, 1,   64, 1,   false},
+    {"rw-alloc",      false, 0,  0,   0,  0,   true},
+};
+
+/** Measured phases, in transaction order.
+**/
+enum Phase: size_t {
+    Begin,
+    Read,
+    Write,
+    Alloc,
+    Free,
+    End,
+    nbphases
+};
+static char const* const phase_names[nbphases] = {"begin", "read", "write", "alloc", "free", "end"};
+
+/** Get the current time.
+ * @return Current time (in ns)
+**/
+static inline double now() noexcept {
+    return static_cast<double>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** Run one repetition of a scenario.
+ * @param tm         Transactional memory to use (at least 512 words in the first segment)
+ * @param scenario   Scenario to run
+ * @param iterations Number of transactions to time
+ * @param aborts     Number of unexpected aborts, incremented
+ * @return Average duration of each phase (in ns, cost of reading the clock subtracted), per call for the reads, writes, allocations and frees
+**/
+static auto run(TransactionalMemory const& tm, Scenario const& scenario, size_t iterations, size_t& aborts) {
+    auto const word = tm.get_align();
+    auto const base = reinterpret_cast<uintptr_t>(tm.get_start());
+    ::std::vector<char> buffer(512 * word); // Private source/target of the reads and writes
+    double sums[nbphases] = {};
+    double overhead = 0.; // Total cost of reading the clock, measured alongside
+    size_t done = 0;
+    while (done < iterations) {
+        double time[nbphases + 1];
+        void* segment = nullptr;
+        auto tx = STM::invalid_tx;
+        auto null = now(); // Calibrate the clock in the same context as the measured phases
+        time[Begin] = now();
+        tx = tm.begin(scenario.ro);
+        time[Read] = now();
+        if (unlikely(tx == STM::invalid_tx))
+            throw Exception::TransactionBegin{};
+        bool committed = true;
+        for (size_t i = 0; committed && i < scenario.nbreads; ++i)
+            committed = tm.read(tx, reinterpret_cast<void const*>(base + i * scenario.rdwords * word), scenario.rdwords * word, buffer.data());
+        time[Write] = now();
+        for (size_t i = 0; committed && i < scenario.nbwrites; ++i)
+            committed = tm.write(tx, buffer.data(), scenario.wrwords * word, reinterpret_cast<void*>(base + i * scenario.wrwords * word));
+        time[Alloc] = now();
+        if (committed && scenario.alloc) {
+            auto res = tm.alloc(tx, 8 * word, &segment);
+            if (unlikely(res == STM::Alloc::nomem))
+                throw Exception::TransactionAlloc{};
+            committed = res == STM::Alloc::success;
+        }
+        time[Free] = now();
+        time[End] = time[Free]; // The free runs in the next transaction
+        if (committed)
+            committed = tm.end(tx);
+        time[nbphases] = now();
+        double freed = 0.;
+        if (committed && scenario.alloc) { // Free the segment in a transaction of its own, timing only the free
+            tx = tm.begin(false);
+            if (unlikely(tx == STM::invalid_tx))
+                throw Exception::TransactionBegin{};
+            auto start = now();
+            committed = tm.free(tx, segment);
+            freed = now() - start;
+            if (committed)
+                committed = tm.end(tx);
+        }
+        if (unlikely(!committed)) {
+            ++aborts;
+            continue;
+        }
+        overhead += time[Begin] - null;
+        for (size_t p = 0; p < nbphases; ++p) {
+            if (p != Free)
+                sums[p] += time[p + 1] - time[p];
+        }
+        sums[Free] += freed;
+        ++done;
+    }
+    size_t const calls[nbphases] = {1, scenario.nbreads, scenario.nbwrites, scenario.alloc ? size_t{1} : 0, scenario.alloc ? size_t{1} : 0, 1};
+    ::std::vector<double> res(nbphases, ::std::nan(""));
+    for (size_t p = 0; p < nbphases; ++p) {
+        if (calls[p] > 0)
+            res[p] = ::std::max(0., (sums[p] - overhead) / static_cast<double>(iterations * calls[p]));
+    }
+    return res;
+}
+
+/** Print the usage.
+ * @param argv0 Program name
+**/
+static void usage(char const* argv0) {
+    ::std::cout << "Usage: " << argv0 << " [options] <library path>..." << ::std::endl;
+    ::std::cout << "Options ('--key value'):" << ::std::endl;
+    ::std::cout << "  --iterations <n>     Number of timed transactions per repetition (default: 100000)" << ::std::endl;
+    ::std::cout << "  --repeats <n>        Number of repetitions (keep the median) (default: 7)" << ::std::endl;
+    ::std::cout << "  --format <csv|json>  Format of the machine-readable report (default: none)" << ::std::endl;
+    ::std::cout << "  --output <path>      Path of the machine-readable report, '-' for stdout (default: -)" << ::std::endl;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Program entry point.
+ * @param argc Arguments count
+ * @param argv Arguments values
+ * @return Program return code
+**/
+int main(int argc, char** argv) {
+    try {
+        size_t iterations = 100000;
+        size_t nbrepeats  = 7;
+        auto format = Report::Format::none;
+        ::std::string output = "-";
+        ::std::vector<char const*> libraries;
+        for (int i = 1; i < argc; ++i) {
+            ::std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                libraries.push_back(argv[i]);
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 1;
+            }
+            char const* value = argv[++i];
+            if (arg == "--iterations" || arg == "--repeats") {
+                char* end;
+                auto number = ::std::strtoul(value, &end, 10);
+                if (*end != '\0' || number == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                (arg == "--iterations" ? iterations : nbrepeats) = number;
+            } else if (arg == "--format" && (::std::strcmp(value, "csv") == 0 || ::std::strcmp(value, "json") == 0)) {
+                format = ::std::strcmp(value, "csv") == 0 ? Report::Format::csv : Report::Format::json;
+            } else if (arg == "--output") {
+                output = value;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        if (libraries.empty()) {
+            usage(argv[0]);
+            return 1;
+        }
+        ::std::cout << "⎧ #iterations:         " << iterations << ::std::endl;
+        ::std::cout << "⎩ #repetitions:        " << nbrepeats << ::std::endl;
+        Report report;
+        for (auto path: libraries) {
+            ::std::cout << "⎧ Microbenchmarking '" << path << "'..." << ::std::endl;
+            TransactionalLibrary tl{path};
+            TransactionalMemory tm{tl, sizeof(void*), 512 * sizeof(void*)};
+            size_t aborts = 0;
+            for (auto&& scenario: scenarios) {
+                run(tm, scenario, iterations / 10 + 1, aborts); // Warm-up
+                ::std::vector<::std::vector<double>> samples(nbphases);
+                for (size_t r = 0; r < nbrepeats; ++r) {
+                    auto res = run(tm, scenario, iterations, aborts);
+                    for (size_t p = 0; p < nbphases; ++p)
+                        samples[p].push_back(res[p]);
+                }
+                Record record;
+                record.set("library", path);
+                record.set("scenario", scenario.name);
+                record.set("iterations", static_cast<double>(iterations));
+                record.set("repeats", static_cast<double>(nbrepeats));
+                auto last = &scenario == &scenarios[sizeof(scenarios) / sizeof(*scenarios) - 1];
+                auto label = ::std::string{scenario.name} + ":";
+                ::std::cout << (last ? "⎩ " : "⎪ ") << label << ::std::string(label.size() < 15 ? 15 - label.size() : 1, ' ');
+                for (size_t p = 0; p < nbphases; ++p) {
+                    auto median = Summary{samples[p]}.median;
+                    record.set(::std::string{phase_names[p]} + "_ns", median);
+                    if (::std::isnan(median))
+                        continue;
+                    ::std::cout << (p > 0 ? ", " : "") << phase_names[p] << " " << median << " ns";
+                    auto words = p == Read ? scenario.rdwords : p == Write ? scenario.wrwords : 0;
+                    if (words > 1)
+                        ::std::cout << " (" << (median / static_cast<double>(words)) << " ns/word)";
+                }
+                ::std::cout << ::std::endl;
+                report.add(::std::move(record));
+            }
+            if (aborts > 0)
+                ::std::cout << "  (" << aborts << " unexpected abort(s) of uncontended transactions, not timed)" << ::std::endl;
+        }
+        report.write(format, output);
+        return 0;
+    } catch (::std::exception const& err) {
+        ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
+        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,384 @@
+/**
+ * @file   profiler.cpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Profiling shim, to preload ('LD_PRELOAD') in any program loading transactional libraries with 'dlopen'.
+ * It interposes 'dlsym': every 'tm_*' entry point resolved from a library is replaced by a wrapper bound to that library,
+ * which times the call and keeps per-thread statistics. When a shared memory region is destroyed, the statistics
+ * of its library since the last dump are printed to the file named by 'TM_PROFILE_OUTPUT' (appended), or to stderr.
+ * 'dlsym(RTLD_NEXT, ...)' calls are resolved relative to the shim, which is fine as long as no library relies on it.
+**/
+
+// External headers
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+extern "C" {
+#include <dlfcn.h>
+}
+
+// Internal headers
+#include <tm.hpp>
+#include "stats.hpp"
+
+using namespace std;
+
+// -------------------------------------------------------------------------- //
+// Statistics
+
+// Wrapped entry points, in the order 'TransactionalLibrary' resolves them
+enum Sym: size_t { TmCreate, TmDestroy, TmStart, TmSize, TmAlign, TmBegin, TmEnd, TmRead, TmWrite, TmAlloc, TmFree, nbsyms };
+static char const* const sym_names[nbsyms] = {"tm_create", "tm_destroy", "tm_start", "tm_size", "tm_align", "tm_begin", "tm_end", "tm_read", "tm_write", "tm_alloc", "tm_free"};
+
+// Statistics of one thread on one library
+struct ThreadStats {
+    Histogram latency[nbsyms];     // Duration of each call (in ns)
+    uint_fast64_t aborts[nbsyms];  // Number of aborts reported by each entry point
+    uint_fast64_t attempts[2];     // Number of begun transactions, read-write then read-only
+    uint_fast64_t commits[2];      // Number of committed transactions, read-write then read-only
+    Histogram reads, read_bytes;   // Read set of each committed transaction (calls and bytes)
+    Histogram writes, write_bytes; // Write set of each committed transaction (calls and bytes)
+    // Running transaction
+    bool ro = false;
+    uint_fast64_t nbreads = 0, nbread_bytes = 0, nbwrites = 0, nbwrite_bytes = 0;
+
+    ThreadStats(): aborts{}, attempts{}, commits{} {}
+
+    // A transaction began
+    void open(bool is_ro) noexcept {
+        ro = is_ro;
+        nbreads = nbread_bytes = nbwrites = nbwrite_bytes = 0;
+        ++attempts[ro];
+    }
+
+    // The running transaction committed
+    void commit() noexcept {
+        ++commits[ro];
+        reads.record(nbreads);
+        read_bytes.record(nbread_bytes);
+        writes.record(nbwrites);
+        write_bytes.record(nbwrite_bytes);
+    }
+
+    // Whether the thread called the library since the last reset
+    bool active() const noexcept {
+        for (size_t i = 0; i < nbsyms; ++i) {
+            if (latency[i].get_count() > 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Forget everything, in place since the histograms are large
+    void reset() noexcept {
+        for (size_t i = 0; i < nbsyms; ++i) {
+            latency[i].clear();
+            aborts[i] = 0;
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            attempts[i] = 0;
+            commits[i] = 0;
+        }
+        reads.clear();
+        read_bytes.clear();
+        writes.clear();
+        write_bytes.clear();
+    }
+
+    // Add the statistics of another thread
+    void merge(ThreadStats const& other) noexcept {
+        for (size_t i = 0; i < nbsyms; ++i) {
+            latency[i].merge(other.latency[i]);
+            aborts[i] += other.aborts[i];
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            attempts[i] += other.attempts[i];
+            commits[i] += other.commits[i];
+        }
+        reads.merge(other.reads);
+        read_bytes.merge(other.read_bytes);
+        writes.merge(other.writes);
+        write_bytes.merge(other.write_bytes);
+    }
+};
+
+// Maximum number of distinct libraries wrapped at the same time
+constexpr static size_t nbslots = 8;
+
+// One wrapped library
+static struct Library {
+    mutex lock; // Protects everything below
+    bool used = false;
+    void* base = nullptr; // Load address of the library
+    string path;
+    void* real[nbsyms] = {}; // Resolved entry points
+    vector<unique_ptr<ThreadStats>> threads; // Statistics of each thread that called the library, never freed
+    uint_fast64_t regions = 0; // Number of destroyed regions
+
+    // Register the calling thread
+    ThreadStats* enroll() {
+        auto stats = make_unique<ThreadStats>();
+        lock_guard<mutex> guard{lock};
+        threads.push_back(move(stats));
+        return threads.back().get();
+    }
+
+    // Print and reset the statistics, with all the threads out of the library
+    void dump();
+} libraries[nbslots];
+
+// Statistics of the calling thread, per library
+static thread_local ThreadStats* locals[nbslots] = {};
+
+// Format a count as a percentage of another
+static double percent(uint_fast64_t part, uint_fast64_t whole) {
+    return whole > 0 ? 100. * static_cast<double>(part) / static_cast<double>(whole) : 0.;
+}
+
+void Library::dump() {
+    lock_guard<mutex> guard{lock};
+    auto total = make_unique<ThreadStats>();
+    size_t nbactive = 0; // Threads that called the library for this region, the others enrolled for an earlier one
+    for (auto&& stats: threads) {
+        if (!stats->active())
+            continue;
+        ++nbactive;
+        total->merge(*stats);
+        stats->reset();
+    }
+    auto output = getenv("TM_PROFILE_OUTPUT");
+    auto file = output ? fopen(output, "a") : stderr;
+    if (unlikely(!file)) {
+        fprintf(stderr, "profiler: unable to open '%s'\n", output);
+        file = stderr;
+    }
+    auto attempts = total->attempts[0] + total->attempts[1];
+    auto commits = total->commits[0] + total->commits[1];
+    fprintf(file, "⎧ Profile of '%s', region %lu, %lu thread(s):\n", path.c_str(), static_cast<unsigned long>(regions++), static_cast<unsigned long>(nbactive));
+    fprintf(file, "⎪ Transactions:  %lu attempt(s), %g %% aborts (read-write %g %% of %lu, read-only %g %% of %lu)\n", static_cast<unsigned long>(attempts),
+        percent(attempts - commits, attempts), percent(total->attempts[0] - total->commits[0], total->attempts[0]), static_cast<unsigned long>(total->attempts[0]),
+        percent(total->attempts[1] - total->commits[1], total->attempts[1]), static_cast<unsigned long>(total->attempts[1]));
+    fprintf(file, "⎪ Aborts in:     ");
+    for (auto sym: {TmRead, TmWrite, TmAlloc, TmFree, TmEnd})
+        fprintf(file, "%s%s %lu", sym == TmRead ? "" : ", ", sym_names[sym], static_cast<unsigned long>(total->aborts[sym]));
+    fprintf(file, "\n");
+    for (size_t i = 0; i < nbsyms; ++i) {
+        auto& latency = total->latency[i];
+        if (latency.get_count() == 0)
+            continue;
+        fprintf(file, "⎪ %-14s %lu call(s), p50 %lu ns, p99 %lu ns, max %lu ns\n", (string{sym_names[i]} + ":").c_str(), static_cast<unsigned long>(latency.get_count()),
+            static_cast<unsigned long>(latency.get_percentile(50)), static_cast<unsigned long>(latency.get_percentile(99)), static_cast<unsigned long>(latency.get_max()));
+    }
+    auto set = [&](char const* label, Histogram const& calls, Histogram const& bytes, bool last) {
+        fprintf(file, "%s %-14s p50 %lu (%lu bytes), p99 %lu (%lu bytes), max %lu (%lu bytes) per committed transaction\n", last ? "⎩" : "⎪", label,
+            static_cast<unsigned long>(calls.get_percentile(50)), static_cast<unsigned long>(bytes.get_percentile(50)),
+            static_cast<unsigned long>(calls.get_percentile(99)), static_cast<unsigned long>(bytes.get_percentile(99)),
+            static_cast<unsigned long>(calls.get_max()), static_cast<unsigned long>(bytes.get_max()));
+    };
+    set("Read set:", total->reads, total->read_bytes, false);
+    set("Write set:", total->writes, total->write_bytes, true);
+    if (file != stderr)
+        fclose(file);
+    else
+        fflush(file);
+}
+
+// -------------------------------------------------------------------------- //
+// Wrappers
+
+// Wrappers of the entry points of the library in slot 'S'
+template<size_t S> class Shim final {
+private:
+    // Get a resolved entry point of the library
+    template<class Func> static Func real(Sym sym) noexcept {
+        auto res = libraries[S].real[sym];
+        return *reinterpret_cast<Func*>(&res);
+    }
+    // Get the statistics of the calling thread
+    static ThreadStats& local() {
+        auto& res = locals[S];
+        if (unlikely(!res))
+            res = libraries[S].enroll();
+        return *res;
+    }
+public:
+    static shared_t create(size_t size, size_t align) noexcept {
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_create)>(TmCreate)(size, align);
+        local().latency[TmCreate].record(chrono.delta());
+        return res;
+    }
+    static void destroy(shared_t shared) noexcept {
+        Chrono chrono;
+        chrono.start();
+        real<decltype(&tm_destroy)>(TmDestroy)(shared);
+        local().latency[TmDestroy].record(chrono.delta());
+        libraries[S].dump();
+    }
+    static void* start(shared_t shared) noexcept {
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_start)>(TmStart)(shared);
+        local().latency[TmStart].record(chrono.delta());
+        return res;
+    }
+    static size_t size(shared_t shared) noexcept {
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_size)>(TmSize)(shared);
+        local().latency[TmSize].record(chrono.delta());
+        return res;
+    }
+    static size_t align(shared_t shared) noexcept {
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_align)>(TmAlign)(shared);
+        local().latency[TmAlign].record(chrono.delta());
+        return res;
+    }
+    static tx_t begin(shared_t shared, bool is_ro) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_begin)>(TmBegin)(shared, is_ro);
+        stats.latency[TmBegin].record(chrono.delta());
+        if (likely(res != invalid_tx))
+            stats.open(is_ro);
+        return res;
+    }
+    static bool end(shared_t shared, tx_t tx) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_end)>(TmEnd)(shared, tx);
+        stats.latency[TmEnd].record(chrono.delta());
+        if (likely(res))
+            stats.commit();
+        else
+            ++stats.aborts[TmEnd];
+        return res;
+    }
+    static bool read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_read)>(TmRead)(shared, tx, source, size, target);
+        stats.latency[TmRead].record(chrono.delta());
+        ++stats.nbreads;
+        stats.nbread_bytes += size;
+        if (unlikely(!res))
+            ++stats.aborts[TmRead];
+        return res;
+    }
+    static bool write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_write)>(TmWrite)(shared, tx, source, size, target);
+        stats.latency[TmWrite].record(chrono.delta());
+        ++stats.nbwrites;
+        stats.nbwrite_bytes += size;
+        if (unlikely(!res))
+            ++stats.aborts[TmWrite];
+        return res;
+    }
+    static Alloc alloc(shared_t shared, tx_t tx, size_t size, void** target) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_alloc)>(TmAlloc)(shared, tx, size, target);
+        stats.latency[TmAlloc].record(chrono.delta());
+        if (unlikely(res == Alloc::abort))
+            ++stats.aborts[TmAlloc];
+        return res;
+    }
+    static bool free(shared_t shared, tx_t tx, void* target) noexcept {
+        auto& stats = local();
+        Chrono chrono;
+        chrono.start();
+        auto res = real<decltype(&tm_free)>(TmFree)(shared, tx, target);
+        stats.latency[TmFree].record(chrono.delta());
+        if (unlikely(!res))
+            ++stats.aborts[TmFree];
+        return res;
+    }
+    // Get the wrapper of an entry point
+    static void* get(Sym sym) noexcept {
+        void* const table[nbsyms] = {
+            reinterpret_cast<void*>(&create), reinterpret_cast<void*>(&destroy), reinterpret_cast<void*>(&start),
+            reinterpret_cast<void*>(&size), reinterpret_cast<void*>(&align), reinterpret_cast<void*>(&begin),
+            reinterpret_cast<void*>(&end), reinterpret_cast<void*>(&read), reinterpret_cast<void*>(&write),
+            reinterpret_cast<void*>(&alloc), reinterpret_cast<void*>(&free)};
+        return table[sym];
+    }
+};
+
+// Get the wrapper of an entry point of the library in a given slot
+template<size_t... S> static void* wrapper(size_t slot, Sym sym, index_sequence<S...>) noexcept {
+    static void* (* const getters[])(Sym) = {&Shim<S>::get...};
+    return getters[slot](sym);
+}
+
+// -------------------------------------------------------------------------- //
+// Interposed interface
+
+// The 'dlsym' this shim hides
+static void* real_dlsym(void* handle, char const* name) {
+    using Func = void* (*)(void*, char const*);
+    static auto func = []() -> Func {
+        for (auto version: {"GLIBC_2.34", "GLIBC_2.2.5", "GLIBC_2.17", "GLIBC_2.0"}) {
+            auto res = dlvsym(RTLD_NEXT, "dlsym", version);
+            if (res)
+                return *reinterpret_cast<Func*>(&res);
+        }
+        fprintf(stderr, "profiler: unable to find the real 'dlsym'\n");
+        abort();
+    }();
+    return func(handle, name);
+}
+
+/** Resolve a symbol, wrapping the 'tm_*' entry points of transactional libraries.
+ * @param handle Handle of the module to search, or a pseudo-handle
+ * @param name   Name of the symbol to find
+ * @return Address of the symbol (or of its wrapper), 'nullptr' if not found
+**/
+extern "C" void* dlsym(void* handle, char const* name) noexcept {
+    auto res = real_dlsym(handle, name);
+    if (!res || strncmp(name, "tm_", 3) != 0)
+        return res;
+    size_t sym = 0;
+    while (sym < nbsyms && strcmp(name, sym_names[sym]) != 0)
+        ++sym;
+    Dl_info info;
+    if (sym == nbsyms || !dladdr(res, &info))
+        return res;
+    for (size_t slot = 0; slot < nbslots; ++slot) { // Find the slot of the library, or take a free one
+        auto& library = libraries[slot];
+        lock_guard<mutex> guard{library.lock};
+        if (library.used && (library.base != info.dli_fbase || library.path != info.dli_fname))
+            continue;
+        if (!library.used) {
+            library.used = true;
+            library.base = info.dli_fbase;
+            library.path = info.dli_fname;
+        }
+        library.real[sym] = res;
+        return wrapper(slot, static_cast<Sym>(sym), make_index_sequence<nbslots>{});
+    }
+    static once_flag once;
+    call_once(once, []() { fprintf(stderr, "profiler: more than %lu libraries, the others are not profiled\n", static_cast<unsigned long>(nbslots)); });
+    return res;
+}
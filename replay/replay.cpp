@@ -0,0 +1,405 @@
+/**
+ * @file   replay.cpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Replay of recorded transaction traces against the given libraries, one thread per recorded thread.
+**/
+
+// External headers
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+#include "report.hpp"
+#include "trace.hpp"
+#include "transactional.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Replay, Any, "replay exception");
+    EXCEPTION(ReplayInput, Replay, "unable to read the trace");
+    EXCEPTION(ReplayFormat, Replay, "malformed trace");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** One decoded event.
+**/
+struct Event {
+    Trace::Op op;     // Opcode
+    bool     local;   // For 'Free': whether only the freeing thread ever uses the segment
+    uint64_t segment; // Segment number ('Read', 'Write', 'Alloc', 'Free')
+    uint64_t offset;  // Offset in the segment ('Read', 'Write'), or number of recorded aborts ('End')
+    uint64_t size;    // Size in bytes ('Read', 'Write', 'Alloc')
+};
+
+/** Decoded trace.
+**/
+class TraceFile final {
+public:
+    Trace::Header header; // File header
+    ::std::vector<::std::vector<Event>> threads; // Events of each recorded thread
+    uint64_t nbsegments;   // One more than the largest segment number
+    uint64_t nbtx;         // Number of recorded transactions
+    uint64_t nbaborts;     // Number of aborts while recording
+    size_t   largest;      // Largest access (in bytes)
+    bool     truncated;    // Whether an incomplete last chunk was dropped (recording process killed)
+public:
+    /** Load constructor.
+     * @param path Path of the trace file
+    **/
+    TraceFile(char const* path): nbsegments{1}, nbtx{0}, nbaborts{0}, largest{0}, truncated{false} {
+        ::std::ifstream file{path, ::std::ios::binary};
+        if (unlikely(!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))))
+            throw Exception::ReplayInput{};
+        if (unlikely(::std::memcmp(header.magic, Trace::magic_value, sizeof(header.magic)) != 0 || header.align == 0 || header.size < header.align))
+            throw Exception::ReplayFormat{};
+        ::std::vector<::std::vector<uint8_t>> streams;
+        Trace::Chunk chunk;
+        while (file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))) {
+            if (chunk.thread >= streams.size())
+                streams.resize(chunk.thread + 1);
+            auto& stream = streams[chunk.thread];
+            auto old = stream.size();
+            stream.resize(old + chunk.length);
+            if (unlikely(!file.read(reinterpret_cast<char*>(stream.data() + old), chunk.length))) {
+                stream.resize(old);
+                truncated = true;
+                break;
+            }
+        }
+        for (auto&& stream: streams)
+            threads.push_back(decode(stream));
+        mark_local();
+    }
+private:
+    /** Decode the events of one thread.
+     * @param stream Encoded events
+     * @return Decoded events
+    **/
+    ::std::vector<Event> decode(::std::vector<uint8_t> const& stream) {
+        ::std::vector<Event> res;
+        auto cursor = stream.data();
+        auto end = cursor + stream.size();
+        auto next = [&]() {
+            uint64_t value;
+            if (unlikely(!Trace::get(cursor, end, value)))
+                throw Exception::ReplayFormat{};
+            return value;
+        };
+        while (cursor < end) {
+            Event event{static_cast<Trace::Op>(*(cursor++)), false, 0, 0, 0};
+            switch (event.op) {
+            case Trace::Op::BeginRO:
+            case Trace::Op::BeginRW:
+                break;
+            case Trace::Op::Read:
+            case Trace::Op::Write:
+                event.segment = next();
+                event.offset = next();
+                event.size = next();
+                if (event.size > largest)
+                    largest = event.size;
+                break;
+            case Trace::Op::Alloc:
+                event.segment = next();
+                event.size = next();
+                if (event.segment >= nbsegments)
+                    nbsegments = event.segment + 1;
+                break;
+            case Trace::Op::Free:
+                event.segment = next();
+                break;
+            case Trace::Op::End:
+                event.offset = next();
+                ++nbtx;
+                nbaborts += event.offset;
+                break;
+            default:
+                throw Exception::ReplayFormat{};
+            }
+            res.push_back(event);
+        }
+        return res;
+    }
+    /** Mark the frees of the segments only ever used by the freeing thread, which can be replayed in place.
+    **/
+    void mark_local() {
+        ::std::map<uint64_t, ::std::set<size_t>> users; // Threads using each allocated segment
+        for (size_t t = 0; t < threads.size(); ++t) {
+            for (auto&& event: threads[t]) {
+                if (event.segment > 0)
+                    users[event.segment].insert(t);
+            }
+        }
+        for (size_t t = 0; t < threads.size(); ++t) {
+            for (auto&& event: threads[t]) {
+                if (event.op == Trace::Op::Free)
+                    event.local = users[event.segment].size() == 1;
+            }
+        }
+    }
+};
+
+/** Replay one recorded thread.
+ * @param tm       Transactional memory to replay on
+ * @param trace    Decoded trace
+ * @param events   Events of the thread
+ * @param segments Replayed address of every segment, 'nullptr' if not (yet, or any more) allocated
+ * @param deferred Segments freed by several threads, to free once all threads are done
+ * @param lock     Protects 'deferred'
+ * @return Number of aborts
+**/
+static uint64_t replay_thread(TransactionalMemory const& tm, TraceFile const& trace, ::std::vector<Event> const& events, ::std::vector<::std::atomic<void*>>& segments, ::std::vector<void*>& deferred, ::std::mutex& lock) {
+    ::std::vector<char> buffer(trace.largest + tm.get_align()); // Private source/target of the accesses
+    auto const start = reinterpret_cast<uintptr_t>(tm.get_start());
+    auto const size = tm.get_size();
+    auto const align = tm.get_align();
+    uint64_t aborts = 0;
+    ::std::vector<::std::pair<uint64_t, void*>> allocs; // Segments allocated by the running attempt
+    ::std::vector<Event const*> frees; // Frees of the running attempt
+    auto resolve = [&](Event const& event) -> void* { // Address of an access, redirected into the first segment if its own is missing
+        if (event.segment > 0) {
+            for (auto&& alloc: allocs) {
+                if (alloc.first == event.segment)
+                    return reinterpret_cast<char*>(alloc.second) + event.offset;
+            }
+            auto base = segments[event.segment].load(::std::memory_order_acquire);
+            if (base)
+                return reinterpret_cast<char*>(base) + event.offset;
+        }
+        if (event.segment == 0 && event.offset + event.size <= size)
+            return reinterpret_cast<void*>(start + event.offset);
+        if (unlikely(event.size > size))
+            return nullptr;
+        auto offset = (event.offset % (size - event.size + 1)) / align * align;
+        return reinterpret_cast<void*>(start + offset);
+    };
+    for (size_t first = 0; first < events.size();) {
+        auto tx = tm.begin(events[first].op == Trace::Op::BeginRO);
+        if (unlikely(tx == STM::invalid_tx))
+            throw Exception::TransactionBegin{};
+        auto committed = true;
+        auto last = first + 1;
+        allocs.clear();
+        frees.clear();
+        for (; committed && last < events.size() && events[last].op != Trace::Op::End; ++last) {
+            auto& event = events[last];
+            switch (event.op) {
+            case Trace::Op::Read: {
+                auto address = resolve(event);
+                if (address)
+                    committed = tm.read(tx, address, event.size, buffer.data());
+            } break;
+            case Trace::Op::Write: {
+                auto address = resolve(event);
+                if (address)
+                    committed = tm.write(tx, buffer.data(), event.size, address);
+            } break;
+            case Trace::Op::Alloc: {
+                void* segment;
+                auto res = tm.alloc(tx, event.size, &segment);
+                if (unlikely(res == STM::Alloc::nomem))
+                    throw Exception::TransactionAlloc{};
+                committed = res == STM::Alloc::success;
+                if (committed)
+                    allocs.emplace_back(event.segment, segment);
+            } break;
+            case Trace::Op::Free: {
+                if (!event.local) { // Other threads may still access it, as they replay in their own order
+                    frees.push_back(&event);
+                    break;
+                }
+                void* segment = segments[event.segment].load(::std::memory_order_relaxed);
+                for (auto&& alloc: allocs) {
+                    if (alloc.first == event.segment)
+                        segment = alloc.second;
+                }
+                if (segment) {
+                    committed = tm.free(tx, segment);
+                    frees.push_back(&event);
+                }
+            } break;
+            default:
+                throw Exception::ReplayFormat{};
+            }
+        }
+        if (committed)
+            committed = tm.end(tx);
+        if (unlikely(!committed)) { // Retry the whole transaction, as the recorded program did
+            ++aborts;
+            continue;
+        }
+        for (auto&& alloc: allocs)
+            segments[alloc.first].store(alloc.second, ::std::memory_order_release);
+        for (auto event: frees) {
+            auto address = segments[event->segment].exchange(nullptr, ::std::memory_order_acq_rel);
+            if (address && !event->local) {
+                ::std::unique_lock<::std::mutex> guard{lock};
+                deferred.push_back(address);
+            }
+        }
+        first = last + 1;
+    }
+    return aborts;
+}
+
+/** Print the usage.
+ * @param argv0 Program name
+**/
+static void usage(char const* argv0) {
+    ::std::cout << "Usage: " << argv0 << " [options] <trace path> <library path>..." << ::std::endl;
+    ::std::cout << "Options ('--key value'):" << ::std::endl;
+    ::std::cout << "  --repeats <n>        Number of repetitions (keep the median) (default: 7)" << ::std::endl;
+    ::std::cout << "  --format <csv|json>  Format of the machine-readable report (default: none)" << ::std::endl;
+    ::std::cout << "  --output <path>      Path of the machine-readable report, '-' for stdout (default: -)" << ::std::endl;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Program entry point.
+ * @param argc Arguments count
+ * @param argv Arguments values
+ * @return Program return code
+**/
+int main(int argc, char** argv) {
+    try {
+        size_t nbrepeats = 7;
+        auto format = Report::Format::none;
+        ::std::string output = "-";
+        ::std::vector<char const*> positionals;
+        for (int i = 1; i < argc; ++i) {
+            ::std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                positionals.push_back(argv[i]);
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 1;
+            }
+            char const* value = argv[++i];
+            if (arg == "--repeats") {
+                char* end;
+                nbrepeats = ::std::strtoul(value, &end, 10);
+                if (*end != '\0' || nbrepeats == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+            } else if (arg == "--format" && (::std::strcmp(value, "csv") == 0 || ::std::strcmp(value, "json") == 0)) {
+                format = ::std::strcmp(value, "csv") == 0 ? Report::Format::csv : Report::Format::json;
+            } else if (arg == "--output") {
+                output = value;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        if (positionals.size() < 2) {
+            usage(argv[0]);
+            return 1;
+        }
+        TraceFile const trace{positionals[0]};
+        auto const nbthreads = trace.threads.size();
+        ::std::cout << "⎧ Trace:               " << positionals[0] << ::std::endl;
+        ::std::cout << "⎪ #threads:            " << nbthreads << ::std::endl;
+        ::std::cout << "⎪ #TX:                 " << trace.nbtx << " (" << trace.nbaborts << " abort(s) when recorded)" << (trace.truncated ? ", incomplete last chunk dropped" : "") << ::std::endl;
+        ::std::cout << "⎪ First segment:       " << trace.header.size << " bytes, aligned on " << trace.header.align << ::std::endl;
+        ::std::cout << "⎩ #repetitions:        " << nbrepeats << ::std::endl;
+        Report report;
+        for (size_t l = 1; l < positionals.size(); ++l) {
+            auto path = positionals[l];
+            ::std::cout << "⎧ Replaying on '" << path << "'..." << ::std::endl;
+            TransactionalLibrary tl{path};
+            ::std::vector<double> times;
+            ::std::vector<double> aborts;
+            for (size_t r = 0; r < nbrepeats; ++r) {
+                TransactionalMemory tm{tl, static_cast<size_t>(trace.header.align), static_cast<size_t>(trace.header.size)};
+                ::std::vector<::std::atomic<void*>> segments(trace.nbsegments);
+                for (auto&& segment: segments)
+                    segment.store(nullptr, ::std::memory_order_relaxed);
+                ::std::vector<void*> deferred;
+                ::std::mutex lock;
+                ::std::atomic<size_t> ready{0};
+                ::std::atomic<bool> go{false};
+                ::std::vector<uint64_t> counts(nbthreads, 0);
+                ::std::vector<::std::thread> threads;
+                ::std::atomic<bool> failed{false};
+                for (size_t t = 0; t < nbthreads; ++t) {
+                    threads.emplace_back([&](size_t t) {
+                        ready.fetch_add(1);
+                        while (!go.load(::std::memory_order_acquire))
+                            short_pause();
+                        try {
+                            counts[t] = replay_thread(tm, trace, trace.threads[t], segments, deferred, lock);
+                        } catch (::std::exception const& err) {
+                            ::std::unique_lock<::std::mutex> guard{lock};
+                            ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl << "⎪ " << err.what() << ::std::endl;
+                            failed = true;
+                        }
+                    }, t);
+                }
+                while (ready.load() < nbthreads)
+                    short_pause();
+                Chrono chrono;
+                chrono.start();
+                go.store(true, ::std::memory_order_release);
+                for (auto&& thread: threads)
+                    thread.join();
+                times.push_back(static_cast<double>(chrono.delta()));
+                if (unlikely(failed))
+                    return 1;
+                uint64_t total = 0;
+                for (auto count: counts)
+                    total += count;
+                aborts.push_back(static_cast<double>(total));
+                for (auto address: deferred) { // Segments freed by shared owners, untimed
+                    transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                        tx.free(address);
+                    });
+                }
+            }
+            Summary runtime{times};
+            Summary abort{aborts};
+            auto throughput = static_cast<double>(trace.nbtx) * 1000000000. / runtime.median;
+            ::std::cout << "⎪ Replay time:         " << (runtime.median / 1000000.) << " ms [" << (runtime.min / 1000000.) << ", " << (runtime.max / 1000000.) << "]" << ::std::endl;
+            ::std::cout << "⎪ Throughput:          " << throughput << " TX/s" << ::std::endl;
+            ::std::cout << "⎩ Aborts:              " << abort.median << " (" << (abort.median * 100. / (abort.median + static_cast<double>(trace.nbtx))) << " % of the attempts)" << ::std::endl;
+            Record record;
+            record.set("trace", positionals[0]);
+            record.set("library", path);
+            record.set("threads", static_cast<double>(nbthreads));
+            record.set("transactions", static_cast<double>(trace.nbtx));
+            record.set("repeats", static_cast<double>(nbrepeats));
+            record.set("runtime_ns", runtime);
+            record.set("throughput_txps", throughput);
+            record.set("aborts", abort);
+            report.add(::std::move(record));
+        }
+        report.write(format, output);
+        return 0;
+    } catch (::std::exception const& err) {
+        ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
+        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+constexpr int ALIGN = 8;
+constexpr int NUM_LOCKS = 10000; // Lock table size of the library, words this many bytes apart share a stripe
+constexpr int NUM_COUNTERS = 4;
+constexpr int NUM_THREADS = 8;
+constexpr int NUM_TXNS = 2000; // Committed transactions per thread
+constexpr int SIZE = 2 * NUM_LOCKS;
+
+// Counters at the start of the region, plain words on the same stripes one lock table further
+uint64_t* counter(void* start, int i) {
+    return (uint64_t*)start + i;
+}
+uint64_t* aliased(void* start, int i) {
+    return (uint64_t*)((char*)start + NUM_LOCKS) + i;
+}
+
+// Each transaction increments one counter with tm_add, and every other one also increments the plain word aliasing it with a read and a write
+// Aborted attempts are retried, so at the end every counter must have seen exactly its committed increments
+void thread_work(shared_t shared, int thread_id, std::atomic<uint64_t>* adds, std::atomic<uint64_t>* writes) {
+    void* start = tm_start(shared);
+    for (int i = 0; i < NUM_TXNS; i++) {
+        int c = (thread_id + i) % NUM_COUNTERS;
+        bool plain = (i % 2) == 0;
+        while (true) {
+            tx_t txn = tm_begin(shared, false);
+            if (!tm_add(shared, txn, counter(start, c), 1)) continue;
+            if (plain) {
+                uint64_t value;
+                if (!tm_read(shared, txn, aliased(start, c), ALIGN, &value)) continue;
+                value++;
+                if (!tm_write(shared, txn, &value, ALIGN, aliased(start, c))) continue;
+            }
+            if (tm_end(shared, txn)) break;
+        }
+        adds[c].fetch_add(1);
+        if (plain) writes[c].fetch_add(1);
+    }
+}
+
+int main()
+{
+    shared_t shared = tm_create(SIZE, ALIGN);
+    void* start = tm_start(shared);
+
+    // (1) Increments on top of a write of the same transaction, read back before and after commit
+    {
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value = 5;
+        tm_write(shared, txn, &value, ALIGN, counter(start, 0));
+        tm_add(shared, txn, counter(start, 0), 3);
+        tm_read(shared, txn, counter(start, 0), ALIGN, &value);
+        check(value == 8, "read sees the increment on top of the write");
+        tm_add(shared, txn, counter(start, 1), 2);
+        tm_add(shared, txn, counter(start, 1), -1);
+        tm_read(shared, txn, counter(start, 1), ALIGN, &value);
+        check(value == 1, "read sees the pending increments");
+        check(tm_end(shared, txn), "incrementing transaction commits");
+        check(*counter(start, 0) == 8 && *counter(start, 1) == 1, "increments are applied at commit");
+    }
+
+    // (2) An aborted transaction applies none of its increments
+    {
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value;
+        tm_read(shared, txn, counter(start, 2), ALIGN, &value);
+        tm_add(shared, txn, counter(start, 3), 10);
+
+        tx_t other = tm_begin(shared, false);
+        uint64_t overwrite = 100;
+        tm_write(shared, other, &overwrite, ALIGN, counter(start, 2));
+        check(tm_end(shared, other), "conflicting writer commits");
+
+        check(!tm_end(shared, txn), "transaction with a stale read aborts");
+        check(*counter(start, 3) == 0, "aborted increment is not applied");
+    }
+
+    // (3) Concurrent increments mixed with plain writes on the same stripes
+    uint64_t before[NUM_COUNTERS];
+    uint64_t before_plain[NUM_COUNTERS];
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        before[c] = *counter(start, c);
+        before_plain[c] = *aliased(start, c);
+    }
+    std::atomic<uint64_t> adds[NUM_COUNTERS] = {};
+    std::atomic<uint64_t> writes[NUM_COUNTERS] = {};
+    std::thread threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = std::thread(thread_work, shared, i, adds, writes);
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i].join();
+    }
+    bool counted = true;
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        if (*counter(start, c) != before[c] + adds[c].load() || *aliased(start, c) != before_plain[c] + writes[c].load()) {
+            std::cout << "counter " << c << ": " << *counter(start, c) - before[c] << " increments for " << adds[c].load() << " commits, "
+                      << *aliased(start, c) - before_plain[c] << " writes for " << writes[c].load() << " commits" << std::endl;
+            counted = false;
+        }
+    }
+    check(counted, "every committed increment is applied exactly once");
+
+    tm_counters counters;
+    tm_stats(&counters);
+    std::cout << counters.commits << " commits, " << counters.aborts << " aborts" << std::endl;
+
+    tm_destroy(shared);
+    return report();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <iostream>
+
+// Scaffold shared by the self-checking tests: each check prints one line, and the test ends with report()
+
+inline int failures = 0;
+
+inline void check(bool condition, const char* what) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << what << std::endl;
+    if (!condition) failures++;
+}
+
+// Print the outcome of all the checks, and return the exit code of the test
+inline int report() {
+    std::cout << (failures == 0 ? "All tests passed" : "Some tests failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
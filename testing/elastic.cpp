@@ -0,0 +1,128 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+
+constexpr int ALIGN = 8;
+constexpr int NUM_NODES = 2048; // Large enough for the nodes to share stripes with each other
+constexpr int NUM_UPDATERS = 3;
+constexpr int NUM_WALKS = 200;
+constexpr int MAX_ATTEMPTS = 1000; // Per walk, past that we consider the walk starved
+
+// A node is two words: a value, and the address of the next node (0 for the last one)
+struct Node {
+    uint64_t value;
+    uint64_t next;
+};
+
+// Link the nodes in order, in one regular transaction
+void buildList(shared_t shared, Node* nodes) {
+    tx_t txn = tm_begin(shared, false);
+    for (int i = 0; i < NUM_NODES; i++) {
+        uint64_t next = (i + 1 < NUM_NODES) ? (uint64_t)(uintptr_t)&nodes[i + 1] : 0;
+        tm_write(shared, txn, &next, ALIGN, &nodes[i].next);
+    }
+    tm_end(shared, txn);
+}
+
+// Update random node values until told to stop, the links are never touched
+void updater(shared_t shared, Node* nodes, int thread_id, std::atomic<bool>* stop) {
+    std::minstd_rand engine(thread_id + 1);
+    std::uniform_int_distribution<int> node_dist(0, NUM_NODES - 1);
+    while (!stop->load()) {
+        Node* node = &nodes[node_dist(engine)];
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value;
+        if (!tm_read(shared, txn, &node->value, ALIGN, &value)) continue;
+        value++;
+        tm_write(shared, txn, &value, ALIGN, &node->value);
+        tm_end(shared, txn);
+    }
+}
+
+// Walk the whole list in an elastic transaction, retrying until it commits
+// Returns the number of nodes seen by the committed walk, or -1 if it never committed
+int walk(shared_t shared, Node* nodes) {
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        tx_t txn = tm_begin_elastic(shared);
+        int seen = 0;
+        uint64_t current = (uint64_t)(uintptr_t)&nodes[0];
+        bool alive = true;
+        while (alive && current != 0) {
+            seen++;
+            alive = tm_read(shared, txn, &((Node*)(uintptr_t)current)->next, ALIGN, &current);
+        }
+        if (alive && tm_end(shared, txn)) return seen;
+    }
+    return -1;
+}
+
+int main()
+{
+    shared_t shared = tm_create(NUM_NODES * sizeof(Node), ALIGN);
+    Node* nodes = (Node*)tm_start(shared);
+    buildList(shared, nodes);
+
+    // (1) Elastic walks commit while other threads update nodes behind and ahead of them
+    std::atomic<bool> stop{false};
+    std::thread threads[NUM_UPDATERS];
+    for (int i = 0; i < NUM_UPDATERS; ++i) {
+        threads[i] = std::thread(updater, shared, nodes, i, &stop);
+    }
+    bool all_committed = true;
+    bool all_complete = true;
+    for (int i = 0; i < NUM_WALKS; i++) {
+        int seen = walk(shared, nodes);
+        if (seen < 0) all_committed = false;
+        else if (seen != NUM_NODES) all_complete = false;
+    }
+    stop.store(true);
+    for (int i = 0; i < NUM_UPDATERS; ++i) {
+        threads[i].join();
+    }
+    check(all_committed, "elastic walks commit next to concurrent updates");
+    check(all_complete, "elastic walks see every node");
+
+    // (2) A write after the walk still aborts when a read of the window was overwritten
+    {
+        tx_t txn = tm_begin_elastic(shared);
+        uint64_t value;
+        tm_read(shared, txn, &nodes[0].next, ALIGN, &value);
+        tm_read(shared, txn, &nodes[1].value, ALIGN, &value);
+
+        tx_t other = tm_begin(shared, false);
+        uint64_t overwrite = 12345;
+        tm_write(shared, other, &overwrite, ALIGN, &nodes[1].value);
+        check(tm_end(shared, other), "conflicting writer commits");
+
+        uint64_t written = 777;
+        tm_write(shared, txn, &written, ALIGN, &nodes[2].value);
+        check(!tm_end(shared, txn), "write after an overwritten elastic read aborts");
+        check(nodes[2].value != written, "aborted elastic transaction wrote nothing");
+    }
+
+    // (3) Same thing, but the overwritten read is released first, so it no longer conflicts
+    {
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value;
+        tm_read(shared, txn, &nodes[3].value, ALIGN, &value);
+        tm_release(shared, txn, &nodes[3].value, ALIGN);
+
+        tx_t other = tm_begin(shared, false);
+        uint64_t overwrite = 54321;
+        tm_write(shared, other, &overwrite, ALIGN, &nodes[3].value);
+        check(tm_end(shared, other), "conflicting writer commits");
+
+        uint64_t written = 888;
+        tm_write(shared, txn, &written, ALIGN, &nodes[4].value);
+        check(tm_end(shared, txn), "write after a released read commits");
+        check(nodes[4].value == written, "released transaction wrote its value");
+    }
+
+    tm_destroy(shared);
+    return report();
+}
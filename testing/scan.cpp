@@ -0,0 +1,124 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+constexpr int ALIGN = 8;
+constexpr int SCAN_CHUNK = 4096; // Bytes the library copies at once in a scan, validating each chunk on its own
+constexpr int NUM_WORDS = 2 * SCAN_CHUNK; // Words, so a whole-region scan spans 16 chunks
+constexpr int SIZE = NUM_WORDS * ALIGN;
+constexpr int NUM_WRITERS = 4;
+constexpr int NUM_SCANS = 200; // Committed scans of the whole region
+constexpr uint64_t INITIAL = 100; // Units in each word at the start
+
+// Move one unit from a word to another, over and over, until told to stop
+// The total over all the words never changes, so any consistent snapshot sums to it
+void writer_work(shared_t shared, int thread_id, std::atomic<bool>* stop, std::atomic<uint64_t>* transfers) {
+    uint64_t* words = (uint64_t*)tm_start(shared);
+    uint64_t state = 0x9e3779b97f4a7c15ull * (thread_id + 1);
+    while (!stop->load()) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        int from = (int)((state >> 33) % NUM_WORDS);
+        int to = (int)((state >> 13) % NUM_WORDS);
+        if (from == to) continue;
+        tx_t txn = tm_begin(shared, false);
+        uint64_t source, target;
+        if (!tm_read(shared, txn, &words[from], ALIGN, &source)) continue;
+        if (!tm_read(shared, txn, &words[to], ALIGN, &target)) continue;
+        if (source == 0) {
+            tm_end(shared, txn);
+            continue;
+        }
+        source--;
+        target++;
+        if (!tm_write(shared, txn, &source, ALIGN, &words[from])) continue;
+        if (!tm_write(shared, txn, &target, ALIGN, &words[to])) continue;
+        if (tm_end(shared, txn)) transfers->fetch_add(1);
+    }
+}
+
+int main()
+{
+    shared_t shared = tm_create(SIZE, ALIGN);
+    uint64_t* words = (uint64_t*)tm_start(shared);
+    for (int i = 0; i < NUM_WORDS; i++) {
+        words[i] = INITIAL;
+    }
+
+    // (1) A scan over many chunks sees a consistent total while writers move units between words, read-only or not
+    {
+        static uint64_t copy[NUM_WORDS];
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> transfers{0};
+        std::thread writers[NUM_WRITERS];
+        for (int i = 0; i < NUM_WRITERS; ++i) {
+            writers[i] = std::thread(writer_work, shared, i, &stop, &transfers);
+        }
+        int inconsistent = 0;
+        int aborted = 0;
+        for (int scan = 0; scan < NUM_SCANS;) {
+            tx_t txn = tm_begin(shared, scan % 2 == 0);
+            if (!tm_scan(shared, txn, words, SIZE, copy) || !tm_end(shared, txn)) {
+                aborted++;
+                continue;
+            }
+            uint64_t total = 0;
+            for (int i = 0; i < NUM_WORDS; i++) {
+                total += copy[i];
+            }
+            if (total != INITIAL * NUM_WORDS) inconsistent++;
+            scan++;
+        }
+        stop.store(true);
+        for (int i = 0; i < NUM_WRITERS; ++i) {
+            writers[i].join();
+        }
+        std::cout << NUM_SCANS << " scans (" << aborted << " aborted) against " << transfers.load() << " transfers" << std::endl;
+        check(inconsistent == 0, "every committed scan sees the same total");
+        uint64_t total = 0;
+        for (int i = 0; i < NUM_WORDS; i++) {
+            total += words[i];
+        }
+        check(total == INITIAL * NUM_WORDS, "the transfers keep the total");
+    }
+
+    // (2) A word of a scanned range overwritten by another transaction before commit makes the scanning one abort
+    {
+        uint64_t copy[16];
+        tx_t txn = tm_begin(shared, false);
+        check(tm_scan(shared, txn, &words[0], sizeof(copy), copy), "scan of a quiet range succeeds");
+        uint64_t value = 7;
+        tm_write(shared, txn, &value, ALIGN, &words[100]);
+
+        tx_t other = tm_begin(shared, false);
+        uint64_t overwrite = 1000;
+        tm_write(shared, other, &overwrite, ALIGN, &words[5]);
+        check(tm_end(shared, other), "conflicting writer commits");
+
+        check(!tm_end(shared, txn), "transaction with a stale scan aborts");
+        check(words[100] != 7, "aborted write is not applied");
+    }
+
+    // (3) A scan inside a transaction that already wrote returns its own writes and increments, whichever of the two it walks
+    {
+        uint64_t base = words[4];
+        uint64_t copy[16];
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value = 77;
+        tm_write(shared, txn, &value, ALIGN, &words[3]);
+        tm_add(shared, txn, &words[4], 5);
+        check(tm_scan(shared, txn, &words[0], sizeof(copy), copy), "scan after writes succeeds");
+        check(copy[3] == 77 && copy[4] == base + 5, "scan of a range larger than the write-set sees the writes");
+        uint64_t one;
+        tm_scan(shared, txn, &words[3], ALIGN, &one);
+        check(one == 77, "scan of a range smaller than the write-set sees the writes");
+        check(tm_end(shared, txn), "transaction commits");
+        check(words[3] == 77 && words[4] == base + 5, "writes are applied at commit");
+    }
+
+    tm_destroy(shared);
+    return report();
+}
@@ -0,0 +1,133 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+constexpr int ALIGN = 8;
+constexpr int SIZE = 1024;
+constexpr int NUM_CAS_THREADS = 3;
+constexpr int NUM_TXN_THREADS = 3;
+constexpr int NUM_READERS = 2;
+constexpr int NUM_INCREMENTS = 5000; // Per incrementing thread
+
+// Increment the counter with tm_load and a tm_cas loop, outside of any transaction
+void cas_work(shared_t shared, uint64_t* counter) {
+    for (int i = 0; i < NUM_INCREMENTS; i++) {
+        uint64_t expected;
+        tm_load(shared, counter, &expected);
+        while (true) {
+            uint64_t desired = expected + 1;
+            if (tm_cas(shared, counter, &expected, &desired)) break;
+        }
+    }
+}
+
+// Increment the counter in full transactions, retried until they commit
+void txn_work(shared_t shared, uint64_t* counter) {
+    for (int i = 0; i < NUM_INCREMENTS; i++) {
+        while (true) {
+            tx_t txn = tm_begin(shared, false);
+            uint64_t value;
+            if (!tm_read(shared, txn, counter, ALIGN, &value)) continue;
+            value++;
+            tm_write(shared, txn, &value, ALIGN, counter);
+            if (tm_end(shared, txn)) break;
+        }
+    }
+}
+
+// Read the counter and the stored word twice per read-only transaction: both reads must agree, and no committed value may go backwards
+void reader_work(shared_t shared, uint64_t* counter, uint64_t* stored, std::atomic<bool>* stop, std::atomic<bool>* consistent) {
+    uint64_t last_counter = 0;
+    uint64_t last_stored = 0;
+    while (!stop->load()) {
+        tx_t txn = tm_begin(shared, true);
+        uint64_t c1, c2, s1, s2;
+        if (!tm_read(shared, txn, counter, ALIGN, &c1)) continue;
+        if (!tm_read(shared, txn, stored, ALIGN, &s1)) continue;
+        std::this_thread::yield();
+        if (!tm_read(shared, txn, counter, ALIGN, &c2)) continue;
+        if (!tm_read(shared, txn, stored, ALIGN, &s2)) continue;
+        if (!tm_end(shared, txn)) continue;
+        if (c1 != c2 || s1 != s2 || c1 < last_counter || s1 < last_stored) consistent->store(false);
+        last_counter = c1;
+        last_stored = s1;
+    }
+}
+
+// Publish increasing values with tm_store until told to stop
+void store_work(shared_t shared, uint64_t* stored, std::atomic<bool>* stop) {
+    for (uint64_t value = 1; !stop->load(); value++) {
+        tm_store(shared, &value, stored);
+    }
+}
+
+int main()
+{
+    shared_t shared = tm_create(SIZE, ALIGN);
+    uint64_t* words = (uint64_t*)tm_start(shared);
+    uint64_t* counter = &words[0];
+    uint64_t* stored = &words[1];
+
+    // (1) Sequential semantics
+    {
+        uint64_t value = 7;
+        tm_store(shared, &value, &words[2]);
+        uint64_t loaded = 0;
+        tm_load(shared, &words[2], &loaded);
+        check(loaded == 7, "tm_load sees tm_store");
+
+        uint64_t expected = 3, desired = 9;
+        check(!tm_cas(shared, &words[2], &expected, &desired), "tm_cas fails on a different word");
+        check(expected == 7 && words[2] == 7, "failed tm_cas returns the current word and leaves it");
+        check(tm_cas(shared, &words[2], &expected, &desired), "tm_cas succeeds on the expected word");
+
+        tx_t txn = tm_begin(shared, true);
+        tm_read(shared, txn, &words[2], ALIGN, &loaded);
+        check(tm_end(shared, txn) && loaded == 9, "transactions see tm_cas");
+
+        // A transaction that read the word before the swap must not commit a write based on it
+        txn = tm_begin(shared, false);
+        tm_read(shared, txn, &words[2], ALIGN, &loaded);
+        expected = 9, desired = 10;
+        tm_cas(shared, &words[2], &expected, &desired);
+        loaded++;
+        tm_write(shared, txn, &loaded, ALIGN, &words[2]);
+        check(!tm_end(shared, txn) && words[2] == 10, "transaction reading a swapped word aborts");
+    }
+
+    // (2) Concurrent tm_cas and transactional increments, with transactional readers and a storing thread
+    std::atomic<bool> stop{false};
+    std::atomic<bool> consistent{true};
+    std::thread incrementers[NUM_CAS_THREADS + NUM_TXN_THREADS];
+    std::thread readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; ++i) {
+        readers[i] = std::thread(reader_work, shared, counter, stored, &stop, &consistent);
+    }
+    std::thread storer(store_work, shared, stored, &stop);
+    for (int i = 0; i < NUM_CAS_THREADS; ++i) {
+        incrementers[i] = std::thread(cas_work, shared, counter);
+    }
+    for (int i = 0; i < NUM_TXN_THREADS; ++i) {
+        incrementers[NUM_CAS_THREADS + i] = std::thread(txn_work, shared, counter);
+    }
+    for (int i = 0; i < NUM_CAS_THREADS + NUM_TXN_THREADS; ++i) {
+        incrementers[i].join();
+    }
+    stop.store(true);
+    storer.join();
+    for (int i = 0; i < NUM_READERS; ++i) {
+        readers[i].join();
+    }
+
+    uint64_t final_count = 0;
+    tm_load(shared, counter, &final_count);
+    check(final_count == (uint64_t)(NUM_CAS_THREADS + NUM_TXN_THREADS) * NUM_INCREMENTS, "no increment is lost");
+    check(consistent.load(), "transactional readers see consistent, increasing values");
+
+    tm_destroy(shared);
+    return report();
+}
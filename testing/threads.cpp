@@ -0,0 +1,93 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+constexpr int ALIGN = 8;
+constexpr int NUM_THREADS = 8;
+constexpr int NUM_TXNS = 1000; // Committed read-write transactions per thread
+constexpr int SIZE = NUM_THREADS * ALIGN;
+
+// Commit NUM_TXNS increments of the thread's own word, then cause exactly one abort:
+// a second transaction of the same thread overwrites a word the first one read
+// Threads never touch each other's words, so these are the only aborts
+void thread_work(shared_t shared, int thread_id, bool explicit_registration, std::atomic<bool>* registered) {
+    if (explicit_registration && !tm_thread_enter()) registered->store(false);
+    uint64_t* word = (uint64_t*)tm_start(shared) + thread_id;
+    for (int i = 0; i < NUM_TXNS; i++) {
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value;
+        tm_read(shared, txn, word, ALIGN, &value);
+        value++;
+        tm_write(shared, txn, &value, ALIGN, word);
+        tm_end(shared, txn);
+    }
+    tx_t txn = tm_begin(shared, false);
+    uint64_t value;
+    tm_read(shared, txn, word, ALIGN, &value);
+    tx_t other = tm_begin(shared, false);
+    tm_write(shared, other, &value, ALIGN, word);
+    tm_end(shared, other);
+    tm_write(shared, txn, &value, ALIGN, word);
+    tm_end(shared, txn);
+    if (explicit_registration) tm_thread_exit();
+}
+
+int main()
+{
+    shared_t shared = tm_create(SIZE, ALIGN);
+    uint64_t* words = (uint64_t*)tm_start(shared);
+
+    // (1) Registration is idempotent, and a thread can leave and come back
+    {
+        check(tm_thread_enter() && tm_thread_enter(), "a thread registers, twice in a row");
+        tm_thread_exit();
+        tm_thread_exit();
+        check(tm_thread_enter(), "a thread registers again after leaving");
+    }
+
+    // (2) The thread's descriptor is handed out again once its transaction ended, a concurrent one gets another
+    {
+        tx_t first = tm_begin(shared, true);
+        tm_end(shared, first);
+        tx_t second = tm_begin(shared, false);
+        tx_t nested = tm_begin(shared, true);
+        check(second == first, "the descriptor is reused by the next transaction");
+        check(nested != second && nested != invalid_tx, "a concurrent transaction gets its own descriptor");
+        uint64_t value = 3;
+        tm_write(shared, second, &value, ALIGN, &words[0]);
+        check(tm_end(shared, nested) && tm_end(shared, second), "both transactions commit");
+        tx_t third = tm_begin(shared, true);
+        check(third == first, "the descriptor is reused after a concurrent transaction");
+        tm_end(shared, third);
+        tm_thread_exit();
+    }
+
+    // (3) The stats of the threads that already exited are kept, explicitly registered or not
+    tm_counters before;
+    tm_stats(&before);
+    std::atomic<bool> registered{true};
+    std::thread threads[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = std::thread(thread_work, shared, i, i % 2 == 0, &registered);
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i].join();
+    }
+    tm_counters after;
+    tm_stats(&after);
+    check(registered.load(), "every explicitly registering thread registers");
+    check(after.commits - before.commits == (uint64_t)NUM_THREADS * (NUM_TXNS + 1), "the commits of the exited threads are all counted");
+    check(after.aborts - before.aborts == (uint64_t)NUM_THREADS, "the aborts of the exited threads are all counted");
+    bool applied = true;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        if (words[i] != (i == 0 ? 3 : 0) + (uint64_t)NUM_TXNS) applied = false;
+    }
+    check(applied, "every committed increment is applied");
+
+    tm_destroy(shared);
+    return report();
+}
@@ -0,0 +1,98 @@
+#include "../include/tm.hpp"
+#include "../include/tm-ext.hpp"
+#include "check.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+constexpr int ALIGN = 8;
+constexpr int NUM_WORDS = 4096;
+constexpr int SIZE = NUM_WORDS * ALIGN;
+constexpr int NUM_VECS = 4;
+
+// Entries of different lengths, scattered over the region, two of them over words written by the transaction
+void makeVecs(uint64_t* words, uint64_t* targets, tm_vec* vecs) {
+    const int offsets[NUM_VECS] = {0, 100, 2000, 4000};
+    const int lengths[NUM_VECS] = {1, 16, 64, 96};
+    for (int v = 0; v < NUM_VECS; v++) {
+        vecs[v] = tm_vec{&words[offsets[v]], lengths[v] * (size_t)ALIGN, &targets[offsets[v]]};
+    }
+}
+
+// Read the same entries with tm_readv and with one tm_read each, in the same transaction, and compare the copies
+bool compareReads(shared_t shared, tx_t txn, uint64_t* words) {
+    static uint64_t vectored[NUM_WORDS];
+    static uint64_t plain[NUM_WORDS];
+    memset(vectored, 0, sizeof(vectored));
+    memset(plain, 0, sizeof(plain));
+    tm_vec vecs[NUM_VECS];
+    makeVecs(words, vectored, vecs);
+    if (!tm_readv(shared, txn, vecs, NUM_VECS)) return false;
+    makeVecs(words, plain, vecs);
+    for (int v = 0; v < NUM_VECS; v++) {
+        if (!tm_read(shared, txn, vecs[v].source, vecs[v].size, vecs[v].target)) return false;
+    }
+    return memcmp(vectored, plain, sizeof(vectored)) == 0;
+}
+
+int main()
+{
+    shared_t shared = tm_create(SIZE, ALIGN);
+    uint64_t* words = (uint64_t*)tm_start(shared);
+
+    // (1) tm_writev commits the same region as tm_write
+    {
+        static uint64_t source[NUM_WORDS];
+        for (int i = 0; i < NUM_WORDS; i++) {
+            source[i] = 1000 + i;
+        }
+        tm_vec vecs[2] = {{&source[0], NUM_WORDS / 2 * (size_t)ALIGN, &words[0]}, {&source[NUM_WORDS / 2], NUM_WORDS / 2 * (size_t)ALIGN, &words[NUM_WORDS / 2]}};
+        tx_t txn = tm_begin(shared, false);
+        check(tm_writev(shared, txn, vecs, 2) && tm_end(shared, txn), "tm_writev commits");
+        check(memcmp(words, source, SIZE) == 0, "tm_writev writes every entry");
+    }
+
+    // (2) Read-write transaction, reading its own writes and increments
+    {
+        tx_t txn = tm_begin(shared, false);
+        uint64_t value = 42;
+        tm_write(shared, txn, &value, ALIGN, &words[100]);
+        tm_write(shared, txn, &value, ALIGN, &words[2010]);
+        tm_add(shared, txn, &words[4001], 5);
+        bool same = compareReads(shared, txn, words);
+        check(same, "tm_readv matches tm_read in a read-write transaction");
+        check(tm_end(shared, txn), "read-write transaction commits");
+    }
+
+    // (3) Read-only transaction
+    {
+        tx_t txn = tm_begin(shared, true);
+        bool same = compareReads(shared, txn, words);
+        check(same, "tm_readv matches tm_read in a read-only transaction");
+        check(tm_end(shared, txn), "read-only transaction commits");
+    }
+
+    // (4) Elastic transaction, where tm_readv falls back to one tm_read per entry
+    {
+        tx_t txn = tm_begin_elastic(shared);
+        bool same = compareReads(shared, txn, words);
+        check(same, "tm_readv matches tm_read in an elastic transaction");
+        check(tm_end(shared, txn), "elastic transaction commits");
+    }
+
+    // (5) A vectored read of a stripe committed after the snapshot aborts, like a plain read
+    {
+        tx_t txn = tm_begin(shared, true);
+        tx_t other = tm_begin(shared, false);
+        uint64_t value = 7;
+        tm_write(shared, other, &value, ALIGN, &words[2030]);
+        tm_end(shared, other);
+        static uint64_t targets[NUM_WORDS];
+        tm_vec vecs[NUM_VECS];
+        makeVecs(words, targets, vecs);
+        check(!tm_readv(shared, txn, vecs, NUM_VECS), "tm_readv of a newer stripe aborts");
+    }
+
+    tm_destroy(shared);
+    return report();
+}
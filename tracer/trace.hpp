@@ -0,0 +1,100 @@
+/**
+ * @file   trace.hpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Binary format of the transaction traces, shared by the recording library and the replay driver.
+ *
+ * A trace file starts with a header (magic, size and alignment of the first segment, in native byte order),
+ * followed by chunks, each made of the recording thread number (32 bits), the chunk length in bytes (32 bits) and the events.
+ * An event is a one-byte opcode followed by its operands, as LEB128 variable-length integers:
+ * - 'BeginRO', 'BeginRW': no operand
+ * - 'Read', 'Write': segment, offset in the segment, size (in bytes)
+ * - 'Alloc': segment (numbered by the recorder), size
+ * - 'Free': segment
+ * - 'End': number of aborted attempts before this committed one
+ * Only committed transactions are recorded. Segment 0 is the first segment, allocated ones are numbered from 1.
+**/
+
+#pragma once
+
+// External headers
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// -------------------------------------------------------------------------- //
+
+namespace Trace {
+
+/** File header.
+**/
+struct Header {
+    char     magic[8]; // Always 'magic_value'
+    uint64_t size;     // Size of the first segment (in bytes)
+    uint64_t align;    // Alignment of the shared memory region (in bytes)
+};
+constexpr static char magic_value[8] = {'T', 'M', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/** Chunk header, followed by 'length' bytes of events of the same thread.
+**/
+struct Chunk {
+    uint32_t thread; // Recording thread number, from 0
+    uint32_t length; // Number of bytes of events
+};
+
+/** Event opcode.
+**/
+enum class Op: uint8_t {
+    BeginRO,
+    BeginRW,
+    Read,
+    Write,
+    Alloc,
+    Free,
+    End
+};
+
+/** Append a variable-length integer.
+ * @param out   Output buffer
+ * @param value Value to append
+**/
+static inline void put(::std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/** Append an opcode.
+ * @param out Output buffer
+ * @param op  Opcode to append
+**/
+static inline void put(::std::vector<uint8_t>& out, Op op) {
+    out.push_back(static_cast<uint8_t>(op));
+}
+
+/** Read a variable-length integer.
+ * @param cursor Read position, advanced
+ * @param end    End of the buffer
+ * @param value  Read value
+ * @return Whether a complete integer was read
+**/
+static inline bool get(uint8_t const*& cursor, uint8_t const* end, uint64_t& value) {
+    value = 0;
+    for (unsigned int shift = 0; cursor < end && shift < 64; shift += 7) {
+        auto byte = *(cursor++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,396 @@
+/**
+ * @file   tracer.cpp
+ * @author Ryan Maxin
+ *
+ * @section LICENSE
+ *
+ * [...]
+ *
+ * @section DESCRIPTION
+ *
+ * Recording transaction library: forwards every 'tm_*' call to the library named by 'TM_TRACE_LIBRARY',
+ * and records the committed transactions of each thread in the trace file named by 'TM_TRACE_OUTPUT' (default: 'tm.trace').
+ * The n-th shared memory region created (from 0) is recorded in '<output>.<n>' for n > 0. See 'trace.hpp' for the format.
+**/
+
+// External headers
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+extern "C" {
+#include <dlfcn.h>
+}
+
+// Internal headers
+#include <tm.hpp>
+#include "macros.hpp"
+#include "trace.hpp"
+
+using namespace std;
+
+// -------------------------------------------------------------------------- //
+// Forwarded library
+
+// The library every call is forwarded to, loaded on the first region creation
+static struct Library {
+    once_flag once;
+    void* module = nullptr;
+    decltype(&tm_create)  create;
+    decltype(&tm_destroy) destroy;
+    decltype(&tm_start)   start;
+    decltype(&tm_size)    size;
+    decltype(&tm_align)   align;
+    decltype(&tm_begin)   begin;
+    decltype(&tm_end)     end;
+    decltype(&tm_read)    read;
+    decltype(&tm_write)   write;
+    decltype(&tm_alloc)   alloc;
+    decltype(&tm_free)    free;
+} library;
+
+// Resolve one symbol of the forwarded library, false if missing
+template<class Func> static bool solve(char const* name, Func& func) {
+    auto res = dlsym(library.module, name);
+    if (unlikely(!res)) return false;
+    func = *reinterpret_cast<Func*>(&res);
+    return true;
+}
+
+// Load the forwarded library, false (with a message) on failure
+static bool load_library() {
+    call_once(library.once, []() {
+        auto path = getenv("TM_TRACE_LIBRARY");
+        if (unlikely(!path)) {
+            fprintf(stderr, "tracer: TM_TRACE_LIBRARY is not set\n");
+            return;
+        }
+        library.module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+        if (unlikely(!library.module)) {
+            fprintf(stderr, "tracer: unable to load '%s': %s\n", path, dlerror());
+            return;
+        }
+        if (unlikely(!solve("tm_create", library.create) || !solve("tm_destroy", library.destroy) || !solve("tm_start", library.start)
+          || !solve("tm_size", library.size) || !solve("tm_align", library.align) || !solve("tm_begin", library.begin)
+          || !solve("tm_end", library.end) || !solve("tm_read", library.read) || !solve("tm_write", library.write)
+          || !solve("tm_alloc", library.alloc) || !solve("tm_free", library.free))) {
+            fprintf(stderr, "tracer: '%s' misses a tm_* symbol\n", path);
+            dlclose(library.module);
+            library.module = nullptr;
+        }
+    });
+    return library.module != nullptr;
+}
+
+// -------------------------------------------------------------------------- //
+// Recording state
+
+// What a thread records on a region
+struct ThreadTrace {
+    uint32_t id;                // Thread number in the trace
+    vector<uint8_t> committed;  // Events of the committed transactions, not yet written
+    vector<uint8_t> attempt;    // Events of the running attempt
+    vector<uintptr_t> allocs;   // Segments allocated by the running attempt
+    vector<uintptr_t> frees;    // Segments freed by the running attempt
+    uint64_t aborts = 0;        // Aborted attempts since the last commit
+};
+
+// One recorded shared memory region
+struct Region {
+    shared_t inner;              // Region of the forwarded library
+    uint64_t generation;         // Distinguishes regions reusing the same address
+    FILE* file;                  // Trace file
+    mutex file_lock;             // Serializes the chunks
+    shared_mutex segments_lock;  // Protects 'segments'
+    map<uintptr_t, pair<uint64_t, size_t>> segments; // Live segments: start address -> (number, size)
+    atomic<uint64_t> next_segment{1};
+    mutex threads_lock;          // Protects 'threads'
+    vector<unique_ptr<ThreadTrace>> threads;
+    atomic<uint64_t> commits{0};
+    atomic<uint64_t> dropped{0}; // Accesses outside of any known segment, not recorded
+};
+
+static atomic<uint64_t> generations{0}; // Number of regions created so far
+
+// Trace of the calling thread on the region it last used
+static thread_local ThreadTrace* current = nullptr;
+static thread_local uint64_t current_generation = ~uint64_t{0};
+
+// Get the trace of the calling thread on the given region, creating it on first use
+static ThreadTrace* thread_trace(Region* region) {
+    if (likely(current && current_generation == region->generation)) return current;
+    auto trace = make_unique<ThreadTrace>();
+    lock_guard<mutex> guard{region->threads_lock};
+    trace->id = static_cast<uint32_t>(region->threads.size());
+    current = trace.get();
+    current_generation = region->generation;
+    region->threads.push_back(move(trace));
+    return current;
+}
+
+// Write the committed events of a thread as one chunk
+static void flush(Region* region, ThreadTrace* trace) {
+    if (trace->committed.empty()) return;
+    Trace::Chunk chunk{trace->id, static_cast<uint32_t>(trace->committed.size())};
+    {
+        lock_guard<mutex> guard{region->file_lock};
+        fwrite(&chunk, sizeof(chunk), 1, region->file);
+        fwrite(trace->committed.data(), 1, trace->committed.size(), region->file);
+        fflush(region->file); // Keep whole chunks on disk should the process be killed
+    }
+    trace->committed.clear();
+}
+
+// Find the segment containing an address, false if none
+static bool locate(Region* region, void const* address, uint64_t& segment, uint64_t& offset) {
+    auto addr = reinterpret_cast<uintptr_t>(address);
+    shared_lock<shared_mutex> guard{region->segments_lock};
+    auto it = region->segments.upper_bound(addr);
+    if (unlikely(it == region->segments.begin())) return false;
+    --it;
+    if (unlikely(addr >= it->first + it->second.second)) return false;
+    segment = it->second.first;
+    offset = addr - it->first;
+    return true;
+}
+
+// Record a read or a write of the running attempt
+static void record_access(Region* region, Trace::Op op, void const* address, size_t size) {
+    uint64_t segment, offset;
+    if (unlikely(!locate(region, address, segment, offset))) {
+        region->dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    auto& out = thread_trace(region)->attempt;
+    Trace::put(out, op);
+    Trace::put(out, segment);
+    Trace::put(out, offset);
+    Trace::put(out, size);
+}
+
+// Discard the running attempt, which the forwarded library aborted
+static void abort_attempt(Region* region, ThreadTrace* trace) {
+    if (!trace->allocs.empty()) { // The library released them
+        unique_lock<shared_mutex> guard{region->segments_lock};
+        for (auto addr: trace->allocs)
+            region->segments.erase(addr);
+    }
+    trace->attempt.clear();
+    trace->allocs.clear();
+    trace->frees.clear();
+    ++trace->aborts;
+}
+
+// -------------------------------------------------------------------------- //
+// Forwarding interface
+
+/** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
+ * @param size  Size of the first shared segment of memory to allocate (in bytes), must be a positive multiple of the alignment
+ * @param align Alignment (in bytes, must be a power of 2) that the shared memory region must support
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create(size_t size, size_t align) noexcept {
+    if (unlikely(!load_library())) return invalid_shared;
+    auto region = new(nothrow) Region;
+    if (unlikely(!region)) return invalid_shared;
+    region->generation = generations.fetch_add(1);
+    string path = getenv("TM_TRACE_OUTPUT") ? getenv("TM_TRACE_OUTPUT") : "tm.trace";
+    if (region->generation > 0)
+        path += "." + to_string(region->generation);
+    region->file = fopen(path.c_str(), "wb");
+    if (unlikely(!region->file)) {
+        fprintf(stderr, "tracer: unable to open '%s'\n", path.c_str());
+        delete region;
+        return invalid_shared;
+    }
+    region->inner = library.create(size, align);
+    if (unlikely(region->inner == invalid_shared)) {
+        fclose(region->file);
+        delete region;
+        return invalid_shared;
+    }
+    Trace::Header header;
+    memcpy(header.magic, Trace::magic_value, sizeof(header.magic));
+    header.size = size;
+    header.align = align;
+    fwrite(&header, sizeof(header), 1, region->file);
+    region->segments.emplace(reinterpret_cast<uintptr_t>(library.start(region->inner)), make_pair(uint64_t{0}, size));
+    return region;
+}
+
+/** Destroy (i.e. clean-up + free) a given shared memory region, writing the rest of its trace.
+ * @param shared Shared memory region to destroy, with no running transaction
+**/
+void tm_destroy(shared_t shared) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    library.destroy(region->inner);
+    for (auto&& trace: region->threads)
+        flush(region, trace.get());
+    fclose(region->file);
+    fprintf(stderr, "tracer: %lu transaction(s) of %lu thread(s) recorded", static_cast<unsigned long>(region->commits.load()), static_cast<unsigned long>(region->threads.size()));
+    if (region->dropped.load() > 0)
+        fprintf(stderr, ", %lu access(es) outside of any segment dropped", static_cast<unsigned long>(region->dropped.load()));
+    fprintf(stderr, "\n");
+    delete region;
+}
+
+/** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
+ * @param shared Shared memory region to query
+ * @return Start address of the first allocated segment
+**/
+void* tm_start(shared_t shared) noexcept {
+    return library.start(reinterpret_cast<Region*>(shared)->inner);
+}
+
+/** [thread-safe] Return the size (in bytes) of the first allocated segment of the shared memory region.
+ * @param shared Shared memory region to query
+ * @return First allocated segment size
+**/
+size_t tm_size(shared_t shared) noexcept {
+    return library.size(reinterpret_cast<Region*>(shared)->inner);
+}
+
+/** [thread-safe] Return the alignment (in bytes) of the memory accesses on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Alignment used globally
+**/
+size_t tm_align(shared_t shared) noexcept {
+    return library.align(reinterpret_cast<Region*>(shared)->inner);
+}
+
+/** [thread-safe] Begin a new transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin(shared_t shared, bool is_ro) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    auto tx = library.begin(region->inner, is_ro);
+    if (likely(tx != invalid_tx))
+        Trace::put(thread_trace(region)->attempt, is_ro ? Trace::Op::BeginRO : Trace::Op::BeginRW);
+    return tx;
+}
+
+/** [thread-safe] End the given transaction, recording it if it committed.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to end
+ * @return Whether the whole transaction committed
+**/
+bool tm_end(shared_t shared, tx_t tx) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    auto trace = thread_trace(region);
+    if (unlikely(!library.end(region->inner, tx))) {
+        abort_attempt(region, trace);
+        return false;
+    }
+    if (!trace->frees.empty()) {
+        unique_lock<shared_mutex> guard{region->segments_lock};
+        for (auto addr: trace->frees)
+            region->segments.erase(addr);
+    }
+    Trace::put(trace->attempt, Trace::Op::End);
+    Trace::put(trace->attempt, trace->aborts);
+    trace->committed.insert(trace->committed.end(), trace->attempt.begin(), trace->attempt.end());
+    trace->attempt.clear();
+    trace->allocs.clear();
+    trace->frees.clear();
+    trace->aborts = 0;
+    region->commits.fetch_add(1, memory_order_relaxed);
+    if (trace->committed.size() >= (1 << 20))
+        flush(region, trace);
+    return true;
+}
+
+/** [thread-safe] Read operation in the given transaction, source in the shared region and target in a private region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in the shared region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in a private region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    if (unlikely(!library.read(region->inner, tx, source, size, target))) {
+        abort_attempt(region, thread_trace(region));
+        return false;
+    }
+    record_access(region, Trace::Op::Read, source, size);
+    return true;
+}
+
+/** [thread-safe] Write operation in the given transaction, source in a private region and target in the shared region.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param source Source start address (in a private region)
+ * @param size   Length to copy (in bytes), must be a positive multiple of the alignment
+ * @param target Target start address (in the shared region)
+ * @return Whether the whole transaction can continue
+**/
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    if (unlikely(!library.write(region->inner, tx, source, size, target))) {
+        abort_attempt(region, thread_trace(region));
+        return false;
+    }
+    record_access(region, Trace::Op::Write, target, size);
+    return true;
+}
+
+/** [thread-safe] Memory allocation in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param size   Allocation requested size (in bytes), must be a positive multiple of the alignment
+ * @param target Pointer in private memory receiving the address of the first byte of the newly allocated, aligned segment
+ * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
+**/
+Alloc tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    auto trace = thread_trace(region);
+    auto res = library.alloc(region->inner, tx, size, target);
+    if (unlikely(res == Alloc::abort)) {
+        abort_attempt(region, trace);
+        return res;
+    }
+    if (unlikely(res != Alloc::success)) return res;
+    auto segment = region->next_segment.fetch_add(1, memory_order_relaxed);
+    auto addr = reinterpret_cast<uintptr_t>(*target);
+    {
+        unique_lock<shared_mutex> guard{region->segments_lock};
+        region->segments[addr] = make_pair(segment, size);
+    }
+    trace->allocs.push_back(addr);
+    Trace::put(trace->attempt, Trace::Op::Alloc);
+    Trace::put(trace->attempt, segment);
+    Trace::put(trace->attempt, size);
+    return res;
+}
+
+/** [thread-safe] Memory freeing in the given transaction.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the first byte of the previously allocated segment to deallocate
+ * @return Whether the whole transaction can continue
+**/
+bool tm_free(shared_t shared, tx_t tx, void* target) noexcept {
+    auto region = reinterpret_cast<Region*>(shared);
+    auto trace = thread_trace(region);
+    if (unlikely(!library.free(region->inner, tx, target))) {
+        abort_attempt(region, trace);
+        return false;
+    }
+    uint64_t segment, offset;
+    if (unlikely(!locate(region, target, segment, offset) || offset != 0)) {
+        region->dropped.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    trace->frees.push_back(reinterpret_cast<uintptr_t>(target));
+    Trace::put(trace->attempt, Trace::Op::Free);
+    Trace::put(trace->attempt, segment);
+    return true;
+}